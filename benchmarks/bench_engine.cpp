@@ -0,0 +1,287 @@
+// Engine throughput benchmarks, written as JSON so runs compare across commits.
+//
+// Usage: bench_engine [--out bench.json] [--repeat R] [--scale X]
+//                     [--max-threads N] [--filter substring]
+//
+// Every benchmark runs a fixed amount of work from fixed seeds and reports
+// the fastest of R repeats; --scale multiplies the work for steadier numbers.
+// VecBattleEnv scaling runs 1, 2, 4, ... threads up to --max-threads
+// (default: all hardware threads).
+
+#include "ai.hpp"
+#include "battle_engine.hpp"
+#include "data.hpp"
+#include "factory.hpp"
+#include "policy.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace pkmn;
+
+namespace {
+
+constexpr uint32_t BENCH_SEED = 1;
+constexpr int BENCH_LEVEL = 50;
+constexpr uint16_t BENCH_MAX_TURNS = 200;
+
+// Work per repeat at --scale 1
+constexpr uint32_t BATTLES = 2000;
+constexpr uint32_t DAMAGE_CALLS = 2000000;
+constexpr uint32_t AI_DECISIONS = 20000;
+constexpr uint32_t FACTORY_TEAMS = 200000;
+constexpr size_t VEC_ENVS = 256;
+constexpr uint32_t VEC_ROUNDS = 32;
+constexpr uint16_t VEC_TURNS = 8;  // Per round: short enough that few battles end first
+
+struct Options {
+    std::string out;
+    int repeat = 3;
+    double scale = 1.0;
+    size_t maxThreads = 0;
+    std::string filter;
+};
+
+struct Result {
+    std::string name;
+    std::string unit;
+    double rate;       // Items per second, best repeat
+    double items;      // Items per repeat
+    double seconds;    // Best repeat
+    size_t threads;
+};
+
+// Keeps benchmarked results alive past the optimizer
+volatile int64_t g_sink = 0;
+
+uint32_t scaled(uint32_t base, double scale) {
+    return std::max<uint32_t>(1, static_cast<uint32_t>(base * scale));
+}
+
+void usage() {
+    std::cerr << "Usage: bench_engine [--out path] [--repeat R] [--scale X] [--max-threads N] "
+                 "[--filter substring]\n";
+}
+
+/// Run `body` (which returns the items it processed) `repeat` times and keep the fastest
+template <typename Body>
+Result measure(const std::string& name, const std::string& unit, size_t threads, int repeat, Body body) {
+    Result result{name, unit, 0.0, 0.0, 0.0, threads};
+    for (int r = 0; r < repeat; r++) {
+        auto start = std::chrono::steady_clock::now();
+        double items = body();
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (r == 0 || secs < result.seconds) {
+            result.seconds = secs;
+            result.items = items;
+        }
+    }
+    result.rate = result.seconds > 0.0 ? result.items / result.seconds : 0.0;
+    return result;
+}
+
+/// Same teams for a given seed: the first six mons of a level-50 rental pool
+void setupBattle(BattleEngine& engine, uint32_t seed) {
+    uint32_t genSeed = seed;
+    FactoryGenerator::RentalPool pool;
+    FactoryGenerator::generateRentalPool(genSeed, 0, false, pool);
+    Pokemon player[3], opponent[3];
+    for (int i = 0; i < 3; i++) {
+        player[i] = FactoryGenerator::createPokemon(pool[i], BENCH_LEVEL);
+        opponent[i] = FactoryGenerator::createPokemon(pool[i + 3], BENCH_LEVEL);
+    }
+    engine.reset(seed);
+    engine.setPlayerTeam(player, 3);
+    engine.setOpponentTeam(opponent, 3);
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+/// Full battles, random player against `opponent`: turns per second
+double benchBattles(PolicyKind opponent, uint32_t battles) {
+    BattleEngine engine;
+    int64_t steps = 0;
+    for (uint32_t b = 0; b < battles; b++) {
+        setupBattle(engine, BENCH_SEED + b);
+        engine.setOpponentPolicy(Policy(opponent));
+        playOut(engine, PolicyKind::Random, BENCH_MAX_TURNS);
+        steps += engine.getTurnCount();
+    }
+    g_sink = g_sink + steps;
+    return static_cast<double>(steps);
+}
+
+double benchDamage(uint32_t calls) {
+    BattleEngine engine;
+    setupBattle(engine, BENCH_SEED);
+    const Pokemon& attacker = engine.getState().getActivePokemon(0);
+    int64_t total = 0;
+    for (uint32_t i = 0; i < calls; i++) {
+        uint16_t moveId = attacker.moves[i % MAX_MOVES];
+        if (moveId != MOVE_NONE) total += engine.calculateDamage(0, 1, moveId);
+    }
+    g_sink = g_sink + total;
+    return static_cast<double>(calls);
+}
+
+/// Scripted AI decisions over positions taken from a few random battles
+double benchAIDecisions(uint32_t decisions) {
+    std::vector<BattleEngine> positions;
+    for (uint32_t b = 0; positions.size() < 64; b++) {
+        BattleEngine engine;
+        setupBattle(engine, BENCH_SEED + b);
+        engine.setOpponentPolicy(Policy(PolicyKind::Random));
+        while (!engine.isTerminal() && positions.size() < 64) {
+            positions.push_back(engine);
+            engine.step(choosePolicyAction(engine, 0, Policy(PolicyKind::Random)));
+        }
+    }
+
+    int64_t total = 0;
+    for (uint32_t i = 0; i < decisions; i++) {
+        BattleEngine& engine = positions[i % positions.size()];
+        total += static_cast<int>(chooseAIAction(engine, 1).type);
+    }
+    g_sink = g_sink + total;
+    return static_cast<double>(decisions);
+}
+
+/// Rental pools and opponent teams (each counts as one team)
+double benchFactoryTeams(uint32_t teams) {
+    uint32_t seed = BENCH_SEED;
+    FactoryGenerator::RentalPool pool;
+    FactoryGenerator::OpponentTeam opponents;
+    int64_t total = 0;
+    for (uint32_t i = 0; i < teams / 2; i++) {
+        int challenge = static_cast<int>(i % 8);
+        FactoryGenerator::generateRentalPool(seed, challenge, i & 1, pool);
+        SpeciesSet excluded;
+        for (uint16_t id : pool) excluded.set(getFrontierMon(id).species);
+        FactoryGenerator::generateOpponentTeam(seed, challenge, 0, i & 1, excluded, opponents);
+        total += pool[0] + opponents[0];
+    }
+    g_sink = g_sink + total;
+    return static_cast<double>(teams / 2 * 2);
+}
+
+/// Live environment steps per second: every round resets all envs and steps
+/// them VEC_TURNS times (Move1 against the scripted AI)
+double benchVecEnv(size_t threads, uint32_t rounds) {
+    VecBattleEnv env(VEC_ENVS, threads);
+    std::vector<uint32_t> seeds(VEC_ENVS);
+    std::vector<uint16_t> ids(VEC_ENVS * 2 * FactoryGenerator::OPPONENT_TEAM_SIZE);
+    std::vector<Action> actions(VEC_ENVS, Action{ActionType::Move1});
+    std::vector<float> rewards(VEC_ENVS);
+    std::unique_ptr<bool[]> dones(new bool[VEC_ENVS]);
+
+    int64_t steps = 0;
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < VEC_ENVS; i++) {
+            seeds[i] = BENCH_SEED + static_cast<uint32_t>(r * VEC_ENVS + i);
+            ids[i * 6 + 0] = static_cast<uint16_t>(seeds[i] * 7 % NUM_FRONTIER_MONS);
+            for (int k = 1; k < 6; k++) {
+                ids[i * 6 + k] = static_cast<uint16_t>((ids[i * 6] + 97 * k) % NUM_FRONTIER_MONS);
+            }
+        }
+        env.reset(seeds.data(), VEC_ENVS);
+        env.setTeamsFromIds(ids.data(), VEC_ENVS, BENCH_LEVEL);
+
+        for (uint16_t turn = 0; turn < VEC_TURNS; turn++) {
+            size_t live = 0;
+            for (size_t i = 0; i < VEC_ENVS; i++) live += !env.getState(i).isTerminal();
+            if (live == 0) break;
+            steps += live;
+            env.step(actions.data(), rewards.data(), dones.get(), VEC_ENVS);
+        }
+    }
+    g_sink = g_sink + steps;
+    return static_cast<double>(steps);
+}
+
+void writeJson(std::ostream& os, const std::vector<Result>& results, const Options& options) {
+    os << "{\n";
+    os << "  \"benchmark\": \"bench_engine\",\n";
+    os << "  \"seed\": " << BENCH_SEED << ",\n";
+    os << "  \"scale\": " << options.scale << ",\n";
+    os << "  \"repeat\": " << options.repeat << ",\n";
+    os << "  \"hardware_threads\": " << ThreadPool::resolveThreadCount(0) << ",\n";
+    os << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        os << "    {\"name\": \"" << r.name << "\", \"unit\": \"" << r.unit << "\", \"rate\": " << r.rate
+           << ", \"items\": " << r.items << ", \"seconds\": " << r.seconds << ", \"threads\": " << r.threads
+           << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (!std::strcmp(arg, "--out")) options.out = value;
+        else if (!std::strcmp(arg, "--repeat")) options.repeat = std::max(1, std::atoi(value));
+        else if (!std::strcmp(arg, "--scale")) options.scale = std::strtod(value, nullptr);
+        else if (!std::strcmp(arg, "--max-threads")) options.maxThreads = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(arg, "--filter")) options.filter = value;
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (!(options.scale > 0.0)) {
+        usage();
+        return 1;
+    }
+    const size_t maxThreads = ThreadPool::resolveThreadCount(options.maxThreads);
+
+    std::vector<Result> results;
+    auto run = [&](const std::string& name, const std::string& unit, size_t threads, auto body) {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+        results.push_back(measure(name, unit, threads, options.repeat, body));
+        const Result& r = results.back();
+        std::cerr << name << ": " << r.rate << " " << unit << " (" << r.seconds << "s)\n";
+    };
+
+    const double scale = options.scale;
+    run("battle_steps_scripted_ai", "steps/s", 1,
+        [&] { return benchBattles(PolicyKind::ScriptedAI, scaled(BATTLES / 4, scale)); });
+    run("battle_steps_random", "steps/s", 1,
+        [&] { return benchBattles(PolicyKind::Random, scaled(BATTLES, scale)); });
+    run("calculate_damage", "calls/s", 1, [&] { return benchDamage(scaled(DAMAGE_CALLS, scale)); });
+    run("choose_ai_action", "decisions/s", 1, [&] { return benchAIDecisions(scaled(AI_DECISIONS, scale)); });
+    run("factory_teams", "teams/s", 1, [&] { return benchFactoryTeams(scaled(FACTORY_TEAMS, scale)); });
+    for (size_t threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        run("vec_env_steps_t" + std::to_string(threads), "steps/s", threads,
+            [&] { return benchVecEnv(threads, scaled(VEC_ROUNDS, scale)); });
+        if (threads >= maxThreads) break;
+    }
+
+    if (options.out.empty()) {
+        writeJson(std::cout, results, options);
+    } else {
+        std::ofstream file(options.out);
+        if (!file) {
+            std::cerr << "Error: cannot write " << options.out << std::endl;
+            return 1;
+        }
+        writeJson(file, results, options);
+    }
+    return 0;
+}
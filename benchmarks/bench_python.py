@@ -0,0 +1,258 @@
+#!/usr/bin/env python3
+"""
+End-to-end throughput of the Python wrappers, written as JSON alongside
+bench_engine's results.
+
+Measures steps/sec for PokemonEnv, FactoryHRL_Env and raw VecBattleEnv at
+several batch sizes. Each wrapper benchmark is run twice: once untouched for
+the headline rate, and once with the native objects wrapped in a timing proxy
+to split each step into binding calls (engine.step, get_legal_actions, ...)
+and Python-side work (_get_obs encoding, the rest of step). The proxy adds a
+little overhead of its own, so the breakdown is reported per step and not
+added back into the headline rate.
+
+Usage:
+    ./build/bench_engine --out results/bench_engine.json
+    python benchmarks/bench_python.py --out results/bench_python.json
+"""
+
+import argparse
+import json
+import os
+import platform
+import random
+import sys
+import time
+
+import numpy as np
+
+# Run from a checkout without installing
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+import pybattle  # noqa: E402
+from pybattle import FactoryHRL_Env, FactoryPhase, PokemonEnv  # noqa: E402
+
+SEED = 1
+VEC_TURNS = 8  # Steps per VecBattleEnv round, as in bench_engine
+
+
+class Timings:
+    """Accumulated ns per call name; calls made while inactive (env resets) are not counted."""
+
+    def __init__(self):
+        self.ns = {}
+        self.active = True
+
+    def add(self, key, ns):
+        if self.active:
+            self.ns[key] = self.ns.get(key, 0) + ns
+
+
+class TimedProxy:
+    """Forwards attribute access to `target`, timing every method call into `timings`."""
+
+    def __init__(self, target, timings, prefix):
+        self._target = target
+        self._timings = timings
+        self._prefix = prefix
+
+    def __getattr__(self, name):
+        attr = getattr(self._target, name)
+        if not callable(attr):
+            return attr
+        key = self._prefix + name
+        timings = self._timings
+
+        def timed(*args, **kwargs):
+            start = time.perf_counter_ns()
+            try:
+                return attr(*args, **kwargs)
+            finally:
+                timings.add(key, time.perf_counter_ns() - start)
+
+        return timed
+
+
+def time_method(obj, name, timings, key):
+    """Replace bound method `name` on `obj` with a timed wrapper."""
+    method = getattr(obj, name)
+
+    def timed(*args, **kwargs):
+        start = time.perf_counter_ns()
+        try:
+            return method(*args, **kwargs)
+        finally:
+            timings.add(key, time.perf_counter_ns() - start)
+
+    setattr(obj, name, timed)
+
+
+def result(name, items, seconds, **extra):
+    out = {"name": name, "unit": "steps/s", "rate": items / seconds if seconds > 0 else 0.0,
+           "items": items, "seconds": seconds}
+    out.update(extra)
+    return out
+
+
+def best_of(repeat, body):
+    """Run body() -> (items, seconds) `repeat` times and keep the fastest."""
+    best = None
+    for _ in range(repeat):
+        items, seconds = body()
+        if best is None or seconds < best[1]:
+            best = (items, seconds)
+    return best
+
+
+def breakdown(timings, total_ns, steps):
+    """Per-step ns for every timed call, plus whatever step() spent outside them."""
+    per_step = {key: ns / steps for key, ns in sorted(timings.ns.items())}
+    timed = sum(timings.ns.values())
+    per_step["python_other"] = max(0.0, (total_ns - timed) / steps)
+    per_step["step_total"] = total_ns / steps
+    return per_step
+
+
+# ============================================================================
+# PokemonEnv
+# ============================================================================
+
+def run_pokemon_env(steps, instrument):
+    env = PokemonEnv(challenge_num=0, is_open_level=True, seed=SEED)
+    rng = random.Random(SEED)
+    timings = Timings()
+    if instrument:
+        env.engine = TimedProxy(env.engine, timings, "engine.")
+        time_method(env, "_get_obs", timings, "_get_obs")
+
+    timings.active = False
+    env.reset(seed=SEED)
+    timings.active = True
+    episode = 0
+    step_ns = 0
+    for _ in range(steps):
+        action = rng.randrange(10)
+        start = time.perf_counter_ns()
+        _, _, terminated, truncated, _ = env.step(action)
+        step_ns += time.perf_counter_ns() - start
+        if terminated or truncated:
+            episode += 1
+            timings.active = False
+            env.reset(seed=SEED + episode)
+            timings.active = True
+    return step_ns, timings
+
+
+# ============================================================================
+# FactoryHRL_Env
+# ============================================================================
+
+def run_factory_env(steps, instrument):
+    env = FactoryHRL_Env(challenge_num=0, is_open_level=True, seed=SEED)
+    rng = random.Random(SEED)
+    timings = Timings()
+    if instrument:
+        env.engine = TimedProxy(env.engine, timings, "engine.")
+        time_method(env, "_get_obs", timings, "_get_obs")
+
+    timings.active = False
+    obs, _ = env.reset(seed=SEED)
+    timings.active = True
+    episode = 0
+    step_ns = 0
+    for _ in range(steps):
+        phase = int(obs[0])
+        if phase == FactoryPhase.RENTAL:
+            action = rng.randrange(20)
+        elif phase == FactoryPhase.SWAP:
+            action = rng.randrange(10)
+        else:
+            legal = np.flatnonzero(obs[80:100])
+            action = int(legal[rng.randrange(len(legal))]) if len(legal) else 0
+        start = time.perf_counter_ns()
+        obs, _, terminated, truncated, _ = env.step(action)
+        step_ns += time.perf_counter_ns() - start
+        if terminated or truncated:
+            episode += 1
+            timings.active = False
+            obs, _ = env.reset(seed=SEED + episode)
+            timings.active = True
+    return step_ns, timings
+
+
+# ============================================================================
+# VecBattleEnv
+# ============================================================================
+
+def run_vec_env(batch, rounds, threads):
+    """Live env steps and time split between reset/team setup and step calls."""
+    env = pybattle.VecBattleEnv(batch, threads)
+    rng = np.random.default_rng(SEED)
+    actions = np.zeros(batch, dtype=np.uint8)  # Move1
+    timings = {"reset": 0, "set_teams_from_ids": 0, "step": 0}
+    live_steps = 0
+    for r in range(rounds):
+        seeds = np.arange(r * batch, (r + 1) * batch, dtype=np.uint32) + SEED
+        ids = rng.integers(0, 882, size=(batch, 2, 3), dtype=np.uint16)
+
+        start = time.perf_counter_ns()
+        env.reset(seeds)
+        mid = time.perf_counter_ns()
+        env.set_teams_from_ids(ids, 50)
+        timings["reset"] += mid - start
+        timings["set_teams_from_ids"] += time.perf_counter_ns() - mid
+
+        alive = np.ones(batch, dtype=bool)
+        for _ in range(VEC_TURNS):
+            live = int(alive.sum())
+            if live == 0:
+                break
+            start = time.perf_counter_ns()
+            _, dones = env.step(actions)
+            timings["step"] += time.perf_counter_ns() - start
+            live_steps += live
+            alive &= ~dones
+    return live_steps, timings
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--out", default="bench_python.json", help="JSON output path")
+    parser.add_argument("--steps", type=int, default=20000, help="Wrapper steps per repeat")
+    parser.add_argument("--batch-sizes", default="1,16,64,256,1024", help="VecBattleEnv batch sizes")
+    parser.add_argument("--rounds", type=int, default=16, help="VecBattleEnv rounds per repeat")
+    parser.add_argument("--threads", type=int, default=1, help="VecBattleEnv threads (0 = all)")
+    parser.add_argument("--repeat", type=int, default=3, help="Repeats; the fastest is kept")
+    args = parser.parse_args()
+
+    results = []
+    for name, run in (("pokemon_env", run_pokemon_env), ("factory_hrl_env", run_factory_env)):
+        steps, ns = best_of(args.repeat, lambda: (args.steps, run(args.steps, False)[0] / 1e9))
+        step_ns, timings = run(args.steps, True)
+        results.append(result(name, steps, ns, breakdown_ns_per_step=breakdown(timings, step_ns, args.steps)))
+        print(f"{name}: {steps / ns:.0f} steps/s", file=sys.stderr)
+
+    for batch in (int(b) for b in args.batch_sizes.split(",")):
+        runs = [run_vec_env(batch, args.rounds, args.threads) for _ in range(args.repeat)]
+        steps, timings = min(runs, key=lambda r: r[1]["step"])
+        seconds = timings["step"] / 1e9
+        per_step = {key: ns / max(steps, 1) for key, ns in timings.items()}
+        results.append(result(f"vec_env_b{batch}", steps, seconds, batch=batch, threads=args.threads,
+                              breakdown_ns_per_step=per_step))
+        print(f"vec_env_b{batch}: {steps / seconds:.0f} steps/s", file=sys.stderr)
+
+    report = {
+        "benchmark": "bench_python",
+        "seed": SEED,
+        "repeat": args.repeat,
+        "python": platform.python_version(),
+        "results": results,
+    }
+    os.makedirs(os.path.dirname(os.path.abspath(args.out)), exist_ok=True)
+    with open(args.out, "w") as f:
+        json.dump(report, f, indent=2)
+        f.write("\n")
+
+
+if __name__ == "__main__":
+    main()
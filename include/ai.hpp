@@ -3,7 +3,8 @@
 
 namespace pkmn {
 
-// Main AI entry point
-Action chooseAIAction(BattleEngine& engine, uint8_t battlerID);
+// Main AI entry point. If `scores` is non-null it receives the final
+// aiThinking.score of each move slot (0 for empty or out-of-PP slots).
+Action chooseAIAction(BattleEngine& engine, uint8_t battlerID, int8_t* scores = nullptr);
 
 } // namespace pkmn
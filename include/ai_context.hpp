@@ -28,8 +28,10 @@ public:
     // AI Execution
     void execute(uint32_t logicId);
     
-    // VM State
-    std::vector<uint32_t> stack;
+    // VM State: script return offsets (fixed size, like the game's 8-entry AI stack)
+    static constexpr uint8_t STACK_SIZE = 8;
+    uint32_t stack[STACK_SIZE];
+    uint8_t stackSize = 0;
     
     // Context State
     AIThinkingStruct aiThinking;
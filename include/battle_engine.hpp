@@ -1,5 +1,6 @@
 #pragma once
 
+#include "rng.hpp"
 #include "types.hpp"
 #include <vector>
 #include <memory>
@@ -8,6 +9,49 @@ namespace pkmn {
 
 // Forward declarations
 class AIScriptInterpreter;
+class ThreadPool;
+struct LookaheadResult;
+
+/// Upper bound on legal actions for one side (4 moves + 5 switches, or Struggle)
+constexpr int MAX_LEGAL_ACTIONS = 9;
+
+// ============================================================================
+// Chance Outcomes
+//
+// A turn draws from the RNG for the speed tie and, per move, accuracy, crit
+// and the damage roll. Fixing those draws makes a turn deterministic, which
+// is what exact searchers branch on.
+// ============================================================================
+
+/// Forced draws for one move
+struct MoveOutcome {
+    bool hit = true;
+    bool crit = false;
+    uint8_t randFactor = 100;  // Damage roll, 85-100
+};
+
+/// Forced draws for a whole turn; moves are indexed by execution order
+/// (0 = first action of the turn, 1 = second)
+struct TurnOutcome {
+    bool playerFirst = true;  // Only consulted on a speed tie
+    MoveOutcome moves[2];
+};
+
+struct WeightedOutcome {
+    TurnOutcome outcome;
+    float probability;
+};
+
+/// How finely enumerateTurnOutcomes branches
+struct ChanceModel {
+    uint8_t damageBuckets = 4;  // Damage rolls split into this many equal ranges (1-16; 16 = exact)
+    bool branchCrits = true;    // false = crits are ignored (never happen)
+};
+
+/// Per move: a miss plus (crit or not) x buckets; two moves; two tie orders
+constexpr int MAX_DAMAGE_BUCKETS = 16;
+constexpr int MAX_MOVE_BRANCHES = 1 + 2 * MAX_DAMAGE_BUCKETS;
+constexpr int MAX_TURN_OUTCOMES = 2 * MAX_MOVE_BRANCHES * MAX_MOVE_BRANCHES;
 
 // ============================================================================
 // Battle Engine - Main simulator class
@@ -28,6 +72,10 @@ public:
     void setPlayerTeam(const Pokemon* mons, uint8_t count);
     void setOpponentTeam(const Pokemon* mons, uint8_t count);
     
+    /// Overwrite one party slot mid-battle (e.g. to resample a hidden mon);
+    /// out-of-range slots are ignored
+    void setPartyMember(uint8_t side, uint8_t slot, const Pokemon& mon);
+    
     // ========================================================================
     // RL Interface
     // ========================================================================
@@ -38,10 +86,34 @@ public:
     /// Get legal actions for player
     std::vector<Action> getLegalActions() const;
     
-    /// Execute one turn: player takes action, AI responds
+    /// Allocation-free legal actions for either side; writes up to
+    /// MAX_LEGAL_ACTIONS entries to `out` and returns the count
+    int getLegalActions(uint8_t side, Action* out) const;
+    
+    /// Policy step() uses for the opponent (the scripted AI by default);
+    /// kept across reset()
+    void setOpponentPolicy(const Policy& policy) { m_opponentPolicy = policy; }
+    const Policy& getOpponentPolicy() const { return m_opponentPolicy; }
+    
+    /// Execute one turn: player takes action, the opponent policy responds
     /// Returns reward and done flag
     StepResult step(Action playerAction);
     
+    /// Execute one turn with both sides' actions given (no AI call)
+    StepResult stepBoth(Action playerAction, Action opponentAction);
+    
+    /// stepBoth with every chance draw taken from `outcome`; the RNG is untouched
+    StepResult stepWithOutcome(Action playerAction, Action opponentAction, const TurnOutcome& outcome);
+    
+    /// Distinct chance outcomes of a turn with their probabilities (summing to
+    /// 1). Outcomes leading to the same damage are merged. Writes up to
+    /// MAX_TURN_OUTCOMES entries and returns the count.
+    int enumerateTurnOutcomes(Action playerAction, Action opponentAction, const ChanceModel& model,
+                              WeightedOutcome* out) const;
+    
+    /// Who acts first: 1 = player, -1 = opponent, 0 = speed tie
+    int compareTurnOrder(Action playerAction, Action opponentAction) const;
+    
     /// Check if battle is over
     bool isTerminal() const { return m_state.isTerminal(); }
     
@@ -52,29 +124,86 @@ public:
     // Internals (public for testing)
     // ========================================================================
     
-    /// RNG: returns 0-65535
-    uint16_t random();
+    /// RNG: returns 0-65535; `tag` names the call site for the RNG trace (rng.hpp)
+    uint16_t random(RngTag tag = RngTag::Other);
     
     /// RNG: returns 0 to max-1
-    uint16_t randomRange(uint16_t max);
+    uint16_t randomRange(uint16_t max, RngTag tag = RngTag::Other);
+    
+    /// Replace the RNG state (e.g. to resample chance outcomes from a copied
+    /// position). Like reset(), also restarts the counter stream keyed by
+    /// splitMix64(state), so reseeding works in either RngMode.
+    void setRngState(uint32_t state) {
+        m_state.rngState = state;
+        m_rngKey = splitMix64(state);
+        m_rngCounter = 0;
+    }
+    
+    /// Skip `draws` RNG draws: O(log draws) for the LCG, O(1) for the counter
+    void advanceRng(uint64_t draws) {
+        if (m_rngMode == RngMode::Counter) m_rngCounter += draws;
+        else m_state.rngState = emeraldRngJump(m_state.rngState, draws);
+    }
+    
+    /// Which generator random() draws from (kept across reset)
+    void setRngMode(RngMode mode) { m_rngMode = mode; }
+    RngMode getRngMode() const { return m_rngMode; }
+    
+    /// Counter mode stream, e.g. counterRngKey(globalSeed, env, episode);
+    /// call after reset(), which rekeys from its seed
+    void seedCounterRng(uint64_t key, uint64_t counter = 0) {
+        m_rngKey = key;
+        m_rngCounter = counter;
+    }
+    uint64_t getRngKey() const { return m_rngKey; }
+    uint64_t getRngCounter() const { return m_rngCounter; }
     
     /// Calculate damage for a move
     int calculateDamage(uint8_t attacker, uint8_t defender, uint16_t moveId);
     
+    /// Damage for a fixed crit / random-roll outcome (randFactor 85-100); draws no RNG
+    int calculateDamageWithRolls(uint8_t attacker, uint8_t defender, uint16_t moveId,
+                                 bool isCrit, int randFactor) const;
+    
     /// Get type effectiveness multiplier (0, 0.25, 0.5, 1, 2, 4)
     float getTypeEffectiveness(Type attackType, Type defType1, Type defType2);
     
     /// Get current turn count
     uint16_t getTurnCount() const { return m_state.turnNumber; }
     
+    /// Zobrist hash of the current state (incrementally maintained)
+    uint64_t getHash() const { return m_state.hash; }
+    
 private:
     BattleState m_state;
+    Policy m_opponentPolicy;
+    
+    // Forced chance outcomes (stepWithOutcome); m_forcedMove is the execution slot
+    TurnOutcome m_forced;
+    bool m_forcing = false;
+    uint8_t m_forcedMove = 0;
+    
+    // Counter-based RNG (RngMode::Counter); the LCG state is m_state.rngState
+    RngMode m_rngMode = RngMode::GameLCG;
+    uint64_t m_rngKey = 0;
+    uint64_t m_rngCounter = 0;
+    
+    // Chance draws: from m_forced while forcing, otherwise from the RNG
+    bool rollSpeedTie();
+    bool rollAccuracy(int accuracy);
+    bool rollCrit(int critStage);
+    int rollDamage();
     
     // Internal turn execution
     void executeTurn(Action playerAction, Action opponentAction);
+    void executeAction(uint8_t side, Action action, uint8_t slot);
     void executeMove(uint8_t attacker, uint8_t defender, uint16_t moveId);
     void executeSwitch(uint8_t side, uint8_t newPartyIndex);
     void applyEndOfTurnEffects();
+    void replaceFaintedActives();
+    
+    // State writes that keep the Zobrist hash current
+    void setActiveHP(uint8_t side, int hp);
     
     // Determine turn order
     struct TurnOrder {
@@ -82,6 +211,14 @@ private:
         Action firstAction, secondAction;
     };
     TurnOrder determineTurnOrder(Action playerAction, Action opponentAction);
+    
+    // Branches for one action of the current state (enumerateTurnOutcomes)
+    struct MoveBranch {
+        MoveOutcome outcome;
+        float probability;
+        int damage;  // Merge key
+    };
+    int moveBranches(uint8_t side, Action action, const ChanceModel& model, MoveBranch* out) const;
 };
 
 // ============================================================================
@@ -89,29 +226,63 @@ private:
 // ============================================================================
 class VecBattleEnv {
 public:
-    explicit VecBattleEnv(size_t numEnvs);
+    /// numThreads = 1 steps on the calling thread, 0 uses all hardware threads
+    explicit VecBattleEnv(size_t numEnvs, size_t numThreads = 1);
+    ~VecBattleEnv();
+    
+    /// Opponent policy for every environment's step()
+    void setOpponentPolicy(const Policy& policy);
+    
+    /// Resize the worker pool used by step() and the bulk setters
+    void setNumThreads(size_t numThreads);
+    size_t numThreads() const;
     
     /// Reset all environments with given seeds
     void reset(const uint32_t* seeds, size_t count);
     
+    /// RNG generator of every environment (BattleEngine::setRngMode)
+    void setRngMode(RngMode mode);
+    
+    /// Key environment i's counter stream by counterRngKey(globalSeed, i,
+    /// episodes[i]); call after reset(), which rekeys from the seeds
+    void seedCounterRngs(uint64_t globalSeed, const uint64_t* episodes, size_t count);
+    
     /// Step all environments
     /// Actions, observations, rewards, dones must be pre-allocated
     void step(const Action* actions, float* rewards, bool* dones, size_t count);
     
+    /// Step all environments with both sides' actions laid out as [count][2]
+    /// (player, opponent); the scripted AI is never consulted
+    void stepBoth(const Action* actions, float* rewards, bool* dones, size_t count);
+    
+    /// Player-side observations [count][OBS_SIZE] and legal-action masks
+    /// [count][NUM_ACTION_TYPES] of every environment (observation.hpp). If
+    /// aiScores is non-null it gets [count][4] scripted AI move scores for the
+    /// player's active mon, computed on a copy so the battle RNG is untouched.
+    void observe(float* obs, uint8_t* masks, int8_t* aiScores, size_t count) const;
+    
     /// Set teams for a specific environment
     void setPlayerTeam(size_t idx, const Pokemon* mons, uint8_t count);
     void setOpponentTeam(size_t idx, const Pokemon* mons, uint8_t count);
     
+    /// Set both teams of every environment from FRONTIER_MONS ids laid out as
+    /// [count][2][3] (player then opponent), built at the given level
+    void setTeamsFromIds(const uint16_t* ids, size_t count, int level);
+    
     /// Get state for a specific environment
     const BattleState& getState(size_t idx) const { return m_envs[idx].getState(); }
     
     /// Get legal actions for a specific environment
     std::vector<Action> getLegalActions(size_t idx) const { return m_envs[idx].getLegalActions(); }
     
+    /// lookaheadAll (lookahead.hpp) from environment `idx` on this env's pool
+    LookaheadResult lookaheadAll(size_t idx, uint32_t samples, uint64_t seed = 0) const;
+    
     size_t size() const { return m_envs.size(); }
     
 private:
     std::vector<BattleEngine> m_envs;
+    std::unique_ptr<ThreadPool> m_pool;
 };
 
 }  // namespace pkmn
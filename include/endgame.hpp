@@ -0,0 +1,101 @@
+#pragma once
+
+#include "battle_engine.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace pkmn {
+
+// ============================================================================
+// 1v1 Endgame Solver
+//
+// Exact win probability and Nash policy for positions where each side has a
+// single mon left. With no switches, each turn is a matrix game over the two
+// movesets whose cells are the chance-weighted values of the successor
+// positions (every distinct damage roll, crit, miss and speed tie). Results
+// are memoized on a compact key of everything a 1v1 turn reads (HP, status,
+// stat stages, volatiles, screens, weather, PP, and the two mons' identity)
+// but not the RNG, so a table built once serves every later query with the
+// same matchup.
+//
+// PP is keyed only up to ENDGAME_PP_CAP: positions that differ only above the
+// cap share a value, which is exact unless some move would still be used
+// ENDGAME_PP_CAP more times before the battle ends. Exact PP grows the table
+// about 40x on ordinary matchups, and a cap of 8 grows stall matchups to
+// millions of positions.
+//
+// Positions that can recur (misses above the PP cap, Struggle, Leftovers
+// undoing damage) form strongly connected components of the position graph.
+// The search finds them with Tarjan's algorithm and solves each one as a
+// whole, iterating its stage games to a fixed point before any member is
+// memoized; play that can loop forever is worth 0.5.
+// ============================================================================
+
+constexpr int ENDGAME_PP_CAP = 4;
+
+/// True when each side has exactly one non-fainted mon
+bool isOneVsOne(const BattleEngine& engine);
+
+struct EndgameConfig {
+    ChanceModel chance{16, true};     // 16 buckets = every damage roll
+    uint32_t solverIterations = 2000;  // Regret matching for mixed states; saddle points are exact
+};
+
+struct EndgameSolution {
+    float value;                               // Player's win probability (0.5 for endless play)
+    float playerPolicy[NUM_ACTION_TYPES];      // Nash strategy indexed by ActionType
+    float opponentPolicy[NUM_ACTION_TYPES];
+};
+
+class EndgameSolver {
+public:
+    explicit EndgameSolver(const EndgameConfig& config = {});
+    ~EndgameSolver();
+
+    /// Solve (or look up) a 1v1 position. Returns false, leaving `out`
+    /// untouched, if the position isn't 1v1. Thread-safe.
+    bool solve(const BattleEngine& engine, EndgameSolution& out);
+
+    /// Player's win probability for a 1v1 position, or -1 if it isn't 1v1.
+    /// Thread-safe, for use as a leaf evaluator.
+    float value(const BattleEngine& engine);
+
+    /// Number of memoized positions
+    size_t size() const;
+    void clear();
+
+    const EndgameConfig& config() const { return m_config; }
+
+private:
+    using Key = std::array<uint64_t, 6>;
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    struct Pending;
+    struct Entry {
+        bool solved;        // false while the position's component is being searched
+        uint32_t index;     // Tarjan numbering while unsolved
+        uint32_t lowLink;
+        EndgameSolution solution;  // Current estimate until solved
+        std::unique_ptr<Pending> pending;
+    };
+
+    static Key makeKey(const BattleState& state);
+    Entry* visit(const BattleEngine& engine, size_t depth);
+    void solveComponent(size_t begin);
+    float solveLocked(const BattleEngine& engine);
+
+    EndgameConfig m_config;
+    std::unordered_map<Key, Entry, KeyHash> m_table;
+    std::vector<std::unique_ptr<WeightedOutcome[]>> m_scratch;  // Outcome buffers per recursion depth
+    std::vector<Entry*> m_stack;                                 // Tarjan stack of unsolved positions
+    uint32_t m_nextIndex = 0;
+    mutable std::mutex m_mutex;
+};
+
+}  // namespace pkmn
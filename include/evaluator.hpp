@@ -0,0 +1,99 @@
+#pragma once
+
+#include "policy.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace pkmn {
+
+// ============================================================================
+// Monte Carlo Evaluators
+//
+// Native value estimates for Battle Factory decisions, simulated in parallel
+// over a thread pool. Every candidate sees the same sampled opponents and
+// battle seeds (common random numbers), so differences between candidates
+// aren't drowned out by opponent luck.
+// ============================================================================
+
+/// Win rate with a 95% Wilson score interval
+struct WinRateEstimate {
+    float winRate;
+    float ciLow;
+    float ciHigh;
+    uint32_t wins;
+    uint32_t samples;
+};
+
+/// Wilson score interval for `wins` out of `samples` (z = 1.96)
+WinRateEstimate makeWinRateEstimate(uint32_t wins, uint32_t samples);
+
+struct EvaluatorConfig {
+    PolicyKind playerPolicy = PolicyKind::ScriptedAI;
+    uint64_t seed = 0;
+    uint16_t maxTurns = 200;  // Capped battles count as losses
+    size_t numThreads = 0;    // 0 = all hardware threads
+};
+
+// ============================================================================
+// Rental Phase
+// ============================================================================
+
+constexpr int NUM_RENTAL_COMBOS = 20;
+using RentalCombo = std::array<uint8_t, 3>;
+
+/// The 20 ways to pick 3 of the 6 rental mons, in the same order as
+/// itertools.combinations(range(6), 3) (FactoryHRL_Env.rental_combos)
+const std::array<RentalCombo, NUM_RENTAL_COMBOS>& getRentalCombos();
+
+/// Estimate the first-battle win rate of each rental combination against
+/// `samples` opponent teams drawn with FactoryGenerator::generateOpponentTeam.
+/// Opponents exclude all six pool species so every combo faces the same teams.
+std::array<WinRateEstimate, NUM_RENTAL_COMBOS> evaluateRentalCombos(
+    const uint16_t pool[6], int challengeNum, bool isOpenLevel, uint32_t samples,
+    const EvaluatorConfig& config = {});
+
+// ============================================================================
+// Swap Phase
+// ============================================================================
+
+constexpr int NUM_SWAP_OPTIONS = 10;
+constexpr int BATTLES_PER_CHALLENGE = 7;
+
+struct SwapEstimate {
+    WinRateEstimate survival;  // P(clearing every remaining battle of the challenge)
+    float meanBattlesWon;      // Expected remaining battles won before the first loss
+};
+
+/// Estimate each swap option after winning battle `battleNum` (0-based, as in
+/// FactoryHRL_Env.current_battle). Option 0 keeps the team; option i in 1-9
+/// replaces team[(i-1)/3] with defeated[(i-1)%3], matching the SWAP action.
+/// Each sample plays the rest of the challenge (no further swaps) against
+/// opponents generated per battle; opponents exclude all six candidate
+/// species so every option faces the same teams. Throws std::runtime_error
+/// unless 0 <= battleNum < BATTLES_PER_CHALLENGE.
+std::array<SwapEstimate, NUM_SWAP_OPTIONS> evaluateSwaps(
+    const uint16_t team[3], const uint16_t defeated[3], int challengeNum, int battleNum,
+    bool isOpenLevel, uint32_t samples, const EvaluatorConfig& config = {});
+
+// ============================================================================
+// Playouts
+// ============================================================================
+
+struct PlayoutStats {
+    WinRateEstimate win;     // Capped playouts count as losses
+    uint32_t capped;         // Playouts that hit maxTurns
+    float meanTurns;         // Turns played past the snapshot
+    float meanPlayerHP;      // Team HP fraction left at the end
+    float meanOpponentHP;
+};
+
+/// Play `n` battles out from `engine` (not modified): `policy` for the player,
+/// the engine's opponent policy for the opponent, at most `maxTurns` turns
+/// each. Playout i reseeds from deriveSeed(seed, 0, i), so results don't
+/// depend on the thread count. Allocation-free per playout, ScriptedAI
+/// included.
+PlayoutStats playouts(const BattleEngine& engine, uint32_t n, PolicyKind policy, uint16_t maxTurns = 200,
+                      uint64_t seed = 0, size_t numThreads = 0);
+
+}  // namespace pkmn
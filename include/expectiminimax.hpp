@@ -0,0 +1,55 @@
+#pragma once
+
+#include "battle_engine.hpp"
+#include <cstdint>
+#include <functional>
+
+namespace pkmn {
+
+class TranspositionTable;
+
+// ============================================================================
+// Expectiminimax Search
+//
+// Exact-ish depth-limited search for endgames and short horizons. Each turn
+// is a max node (player action), a min node (opponent reply, assumed to see
+// the player's choice) and a chance node over the turn's enumerated outcomes
+// (speed tie, accuracy, crit, bucketed damage rolls), each replayed with
+// BattleEngine::stepWithOutcome. Chance nodes are pruned with Star1, plus
+// Star2 probing for lower bounds, and the search deepens iteratively until
+// the depth or time budget runs out. With a transposition table, max nodes
+// reuse bounds searched at least as deep and try the stored best action
+// first; searches sharing one table on the same root help each other. Exact
+// values whose every line reached the end of the battle are stored with
+// depth TT_DEPTH_SOLVED, the only ones MCTS takes in place of its own leaf
+// estimates.
+// ============================================================================
+
+/// Static value of a non-terminal leaf for the player, in [0, 1]
+using StaticEvaluator = std::function<float(const BattleEngine& engine)>;
+
+/// Default leaf value: 0.5 + half the difference in remaining team HP fraction
+float hpFractionValue(const BattleEngine& engine);
+
+struct ExpectiminimaxConfig {
+    uint8_t maxDepth = 3;       // Turns
+    double timeBudgetMs = 0.0;  // 0 = always finish maxDepth
+    ChanceModel chance;
+    bool prune = true;          // Alpha-beta and Star1; off = plain expectiminimax
+    bool star2 = true;          // Probe chance successors for lower bounds first
+    StaticEvaluator evaluator;  // Defaults to hpFractionValue
+    TranspositionTable* table = nullptr;  // Optional; may be shared with concurrent searches
+};
+
+struct ExpectiminimaxResult {
+    Action bestAction;
+    float value;           // Player's value of bestAction at depthReached
+    uint8_t depthReached;  // Deepest fully searched iteration (0 if none finished)
+    uint64_t nodes;        // Chance successors simulated over all iterations
+    double elapsedMs;
+};
+
+/// Search the player's action from `root` (not modified)
+ExpectiminimaxResult searchExpectiminimax(const BattleEngine& root, const ExpectiminimaxConfig& config = {});
+
+}  // namespace pkmn
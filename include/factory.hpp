@@ -2,13 +2,34 @@
 
 #include "types.hpp"
 #include "data.hpp"
+#include <array>
 #include <vector>
 #include <cstdint>
 
 namespace pkmn {
 
+// ============================================================================
+// Species Set
+//
+// 512-bit bitset over species IDs (Gen 3 tops out at 386), used to enforce
+// species uniqueness during team generation without touching the heap.
+// ============================================================================
+struct SpeciesSet {
+    uint64_t words[8] = {};
+
+    bool test(uint16_t species) const { return (words[(species >> 6) & 7] >> (species & 63)) & 1; }
+    void set(uint16_t species) { words[(species >> 6) & 7] |= uint64_t(1) << (species & 63); }
+    void clear() { for (uint64_t& w : words) w = 0; }
+};
+
 class FactoryGenerator {
 public:
+    static constexpr int RENTAL_POOL_SIZE = 6;
+    static constexpr int OPPONENT_TEAM_SIZE = 3;
+
+    using RentalPool = std::array<uint16_t, RENTAL_POOL_SIZE>;
+    using OpponentTeam = std::array<uint16_t, OPPONENT_TEAM_SIZE>;
+
     // Generate 6 rental mons for the player to choose from at the start of a challenge
     // Returns indices into the FRONTIER_MONS array
     static std::vector<uint16_t> generateRentalPool(uint32_t& rngSeed, int challengeNum, bool isOpenLevel);
@@ -18,9 +39,29 @@ public:
     static std::vector<uint16_t> generateOpponentTeam(uint32_t& rngSeed, int challengeNum, int battleNum, bool isOpenLevel,
                                                       const std::vector<uint16_t>& playerExcludes = {});
 
+    // Allocation-free variants: write FRONTIER_MONS indices into `out` and return
+    // how many were written (only short if the challenge range runs out of species).
+    // Picks are drawn without replacement from the precomputed eligible list, so
+    // each call makes at most one RNG draw per eligible mon.
+    static int generateRentalPool(uint32_t& rngSeed, int challengeNum, bool isOpenLevel, RentalPool& out);
+    static int generateOpponentTeam(uint32_t& rngSeed, int challengeNum, int battleNum, bool isOpenLevel,
+                                    const SpeciesSet& excludedSpecies, OpponentTeam& out);
+
+    // Batched variants: one independent generation per seed (seeds are not
+    // advanced), rows written to `out` as [count][RENTAL_POOL_SIZE] or
+    // [count][OPPONENT_TEAM_SIZE]. Opponent species listed in the optional
+    // `excludeIds` rows ([count][excludesPerSeed]) are skipped.
+    // numThreads = 0 uses all hardware threads.
+    static void generateRentalPools(const uint32_t* seeds, size_t count, int challengeNum, bool isOpenLevel,
+                                    uint16_t* out, size_t numThreads = 0);
+    static void generateOpponentTeams(const uint32_t* seeds, size_t count, int challengeNum, int battleNum,
+                                      bool isOpenLevel, uint16_t* out,
+                                      const uint16_t* excludeIds = nullptr, size_t excludesPerSeed = 0,
+                                      size_t numThreads = 0);
+
     // Convert a FrontierMon ID to a full Pokemon instance
     static Pokemon createPokemon(uint16_t frontierMonId, int level, uint8_t fixedIV = 31);
-    
+
     // Helper to get ranges for debugging/UI
     static void getChallengeRanges(int challengeNum, bool isOpenLevel, uint16_t& outStart, uint16_t& outEnd);
 };
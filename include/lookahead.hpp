@@ -0,0 +1,43 @@
+#pragma once
+
+#include "battle_engine.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace pkmn {
+
+class ThreadPool;
+
+// ============================================================================
+// One-Step Lookahead
+//
+// What happens after each legal player action: every action is stepped from
+// a copy of the position `samples` times, with the opponent answering under
+// the engine's opponent policy. Sample k uses the same RNG seed for every
+// action (common random numbers), so the per-action differences come from
+// the action and not from the draws.
+// ============================================================================
+
+struct LookaheadConfig {
+    uint64_t seed = 0;
+    size_t numThreads = 0;  // 0 = all hardware threads
+};
+
+struct LookaheadResult {
+    int count;                                 // Legal player actions (0 if terminal)
+    Action actions[MAX_LEGAL_ACTIONS];
+    uint32_t samples;                          // Per action
+    float winRate[MAX_LEGAL_ACTIONS];          // Battle won this turn
+    float lossRate[MAX_LEGAL_ACTIONS];         // Battle lost this turn
+    float playerHPDelta[MAX_LEGAL_ACTIONS];    // Mean change in the team's HP fraction (<= 0 unless healing)
+    float opponentHPDelta[MAX_LEGAL_ACTIONS];
+};
+
+/// Step every legal player action `samples` times from `engine` (not modified)
+LookaheadResult lookaheadAll(const BattleEngine& engine, uint32_t samples, const LookaheadConfig& config = {});
+
+/// Same on an existing pool; config.numThreads is ignored
+LookaheadResult lookaheadAll(const BattleEngine& engine, uint32_t samples, ThreadPool& pool,
+                             const LookaheadConfig& config = {});
+
+}  // namespace pkmn
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace pkmn {
+
+// ============================================================================
+// Matchup Table
+//
+// Precomputed 1v1 win rates between every ordered pair of frontier mons, per
+// level mode. Built offline by the build_matchup_table tool and memory-mapped
+// at runtime, so lookups are a single load and the table is shared between
+// processes through the page cache.
+//
+// File layout (little endian):
+//   MatchupTableHeader
+//   uint16_t winRate[numLevels][numMons][numMons]
+// winRate[level][a][b] = round(65535 * P(a beats b)), draws counting half.
+// Level 0 = Lv50, level 1 = Open Level (Lv100).
+// ============================================================================
+
+constexpr uint32_t MATCHUP_TABLE_VERSION = 1;
+constexpr uint32_t MATCHUP_TABLE_LEVELS = 2;
+
+struct MatchupTableHeader {
+    char magic[4];       // "PBMT"
+    uint32_t version;    // MATCHUP_TABLE_VERSION
+    uint32_t numMons;    // Rows/columns per level (882 for the full table)
+    uint32_t numLevels;  // MATCHUP_TABLE_LEVELS
+    uint32_t samples;    // Battles simulated per ordered pair
+    uint32_t seed;       // Base seed used to derive battle seeds
+    uint32_t maxTurns;   // Turn cap; capped battles count as draws
+    uint32_t reserved;
+};
+static_assert(sizeof(MatchupTableHeader) == 32, "MatchupTableHeader must stay 32 bytes");
+
+class MatchupTable {
+public:
+    MatchupTable() = default;
+
+    /// Map a table file; throws std::runtime_error if missing or malformed
+    explicit MatchupTable(const std::string& path);
+    ~MatchupTable();
+
+    MatchupTable(const MatchupTable&) = delete;
+    MatchupTable& operator=(const MatchupTable&) = delete;
+    MatchupTable(MatchupTable&& other) noexcept;
+    MatchupTable& operator=(MatchupTable&& other) noexcept;
+
+    bool isOpen() const { return m_header != nullptr; }
+    const MatchupTableHeader& header() const { return *m_header; }
+    /// Rows/columns per level; 0 for a table that isn't open
+    uint32_t numMons() const { return m_header ? m_header->numMons : 0; }
+
+    /// Raw fixed-point entries, [numLevels][numMons][numMons]
+    const uint16_t* data() const { return m_data; }
+
+    /// P(frontier mon a beats frontier mon b) at the given level mode.
+    /// Unchecked: the table must be open and a, b < numMons(), which can be
+    /// less than 882 for tables built with a smaller numMons; see winRateAt().
+    float winRate(uint16_t a, uint16_t b, bool isOpenLevel) const {
+        size_t n = m_header->numMons;
+        return m_data[(static_cast<size_t>(isOpenLevel) * n + a) * n + b] * (1.0f / 65535.0f);
+    }
+
+    /// winRate() that throws std::out_of_range for ids outside the table
+    /// (including any id when the table isn't open)
+    float winRateAt(uint16_t a, uint16_t b, bool isOpenLevel) const {
+        if (a >= numMons() || b >= numMons()) throw std::out_of_range("Frontier mon id outside the matchup table");
+        return winRate(a, b, isOpenLevel);
+    }
+
+    // ========================================================================
+    // Building
+    // ========================================================================
+
+    /// Simulate `samples` 1v1 battles of a (player) vs b (opponent), scripted
+    /// AI on both sides. Returns the fraction won by a, draws counting half.
+    static float simulateMatchup(const Pokemon& a, const Pokemon& b, uint32_t samples,
+                                 uint64_t seed, uint16_t maxTurns);
+
+    /// Simulate every ordered pair among the first `numMons` frontier mons for
+    /// both level modes and write the table to `path`. numThreads = 0 uses all
+    /// hardware threads. Throws std::runtime_error if the file can't be written.
+    static void build(const std::string& path, uint32_t samples, uint32_t seed, size_t numThreads,
+                      uint16_t numMons = 882, uint16_t maxTurns = 200);
+
+private:
+    void close();
+
+    const MatchupTableHeader* m_header = nullptr;
+    const uint16_t* m_data = nullptr;
+    void* m_mapping = nullptr;
+    size_t m_mappedSize = 0;
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mapHandle = nullptr;
+#endif
+};
+
+}  // namespace pkmn
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "battle_engine.hpp"
+#include "policy.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace pkmn {
+
+// ============================================================================
+// Simultaneous-Move Turn Solver
+//
+// Both sides pick their action at the same time, so a turn is a zero-sum
+// matrix game: rows are the player's legal actions, columns the opponent's,
+// and each cell is the player's expected result after that joint action.
+// Cells are estimated in parallel with common random numbers (every cell sees
+// the same battle seeds); the mixed Nash strategies come from regret
+// matching+.
+// ============================================================================
+
+struct MatrixGameConfig {
+    uint32_t samples = 32;                         // Evaluations per cell
+    uint8_t depth = 1;                             // 1 = rollouts after the joint action; d > 1 solves
+                                                   // the resulting turn recursively to depth d - 1
+    PolicyKind rolloutPolicy = PolicyKind::MaxDamage;  // Both sides, self-play via stepBoth
+    uint16_t rolloutMaxTurns = 200;                // Capped rollouts score 0.5
+    uint32_t solverIterations = 2000;              // Regret-matching iterations
+    uint64_t seed = 0;
+    size_t numThreads = 0;                         // 0 = all hardware threads
+};
+
+struct MatrixGameSolution {
+    int rows;                                      // Player's legal actions (0 if terminal)
+    int cols;                                      // Opponent's legal actions
+    Action rowActions[MAX_LEGAL_ACTIONS];
+    Action colActions[MAX_LEGAL_ACTIONS];
+    float payoff[MAX_LEGAL_ACTIONS][MAX_LEGAL_ACTIONS];  // Player's expected result in [0, 1]
+    float rowStrategy[MAX_LEGAL_ACTIONS];
+    float colStrategy[MAX_LEGAL_ACTIONS];
+    float value;                                   // Player's value under both strategies
+    float exploitability;                          // Sum of both best-response gains (0 = exact Nash)
+};
+
+/// Solve a zero-sum game with a row-major rows x cols payoff matrix (row
+/// player maximizes) by regret matching+ with linearly weighted averaging.
+/// Writes the average strategies and returns the row player's value.
+float solveMatrixGame(const float* payoff, int rows, int cols, uint32_t iterations,
+                      float* rowStrategy, float* colStrategy);
+
+/// Build and solve the matrix game for the current turn of `engine`
+MatrixGameSolution solveTurn(const BattleEngine& engine, const MatrixGameConfig& config = {});
+
+}  // namespace pkmn
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "battle_engine.hpp"
+#include "policy.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace pkmn {
+
+class ThreadPool;
+class TranspositionTable;
+
+// ============================================================================
+// Monte Carlo Tree Search
+//
+// Picks the player's action from a BattleEngine position. The tree is
+// open-loop: nodes are player action sequences, and every iteration replays
+// them on a fresh copy of the root with its own RNG seed, so damage rolls,
+// crits and the opponent's replies are resampled rather than stored.
+//
+// Nodes come from a fixed arena allocated once per MctsSearch and recycled
+// between searches. Threads share one tree (tree parallelism) and spread out
+// via virtual loss.
+//
+// With `determinize` set the search becomes information-set MCTS: each
+// iteration also replaces the opponent's unrevealed party slots with mons
+// sampled from the challenge's eligible Frontier sets. The player's legal
+// actions never depend on those hidden slots, so a node (a player action
+// history) is an information set, and its statistics aggregate over every
+// determinization that passed through it.
+// ============================================================================
+
+/// Number of child slots per node (one per ActionType)
+constexpr int MCTS_NUM_ACTIONS = NUM_ACTION_TYPES;
+
+enum class SelectionRule : uint8_t {
+    UCT,   // Q + c * sqrt(ln N / n)
+    PUCT,  // Q + c * P * sqrt(N) / (1 + n)
+};
+
+/// Leaf evaluator: returns the player's value in [0, 1] for `engine` and may
+/// write PUCT priors indexed by ActionType into priors[MCTS_NUM_ACTIONS]
+/// (left uniform if untouched). Called concurrently from search threads.
+using LeafEvaluator = std::function<float(const BattleEngine& engine, float* priors)>;
+
+struct MctsConfig {
+    uint32_t iterations = 10000;    // Total over all threads; 0 = only the time budget applies
+    double timeBudgetMs = 0.0;      // 0 = only the iteration budget applies
+    SelectionRule selection = SelectionRule::UCT;
+    float exploration = 1.41f;
+    uint32_t virtualLoss = 1;       // Pending visits added per in-flight descent
+
+    PolicyKind rolloutPolicy = PolicyKind::Random;
+    uint16_t rolloutMaxTurns = 200;  // Capped rollouts score 0.5
+    uint16_t maxDepth = 64;          // Turns below the root before nodes stop expanding
+    LeafEvaluator evaluator;         // Replaces rollouts when set
+
+    // Leaf estimates shared through a transposition table (optional): each
+    // leaf's value is averaged with earlier samples of the same state, and
+    // states with tableTrustVisits samples (or a value a search solved to the
+    // end of the battle, TT_DEPTH_SOLVED) skip the rollout or evaluator. An
+    // exact value from a depth-limited search is averaged in as one sample.
+    TranspositionTable* table = nullptr;
+    uint32_t tableTrustVisits = 32;
+
+    // Information-set search over hidden opponent mons
+    bool determinize = false;
+    int challengeNum = 0;            // Eligible Frontier range for sampled mons
+    bool isOpenLevel = false;
+
+    size_t numThreads = 1;           // 0 = all hardware threads
+    size_t maxNodes = 1 << 20;       // Arena capacity in nodes
+    size_t memoryBudgetBytes = 0;    // Sizes the arena instead of maxNodes when non-zero
+    uint64_t seed = 0;
+};
+
+struct MctsResult {
+    Action bestAction;                          // Most visited legal root action
+    uint32_t iterations;
+    uint32_t nodesUsed;
+    double elapsedMs;
+    uint32_t visits[MCTS_NUM_ACTIONS];          // Root child visits by ActionType
+    float values[MCTS_NUM_ACTIONS];             // Root child mean values by ActionType
+};
+
+class MctsSearch {
+public:
+    explicit MctsSearch(const MctsConfig& config = {});
+    ~MctsSearch();
+
+    MctsSearch(const MctsSearch&) = delete;
+    MctsSearch& operator=(const MctsSearch&) = delete;
+
+    /// Search from `root` (copied, never modified) and return root statistics
+    MctsResult search(const BattleEngine& root);
+
+    const MctsConfig& config() const { return m_config; }
+
+    /// Arena capacity in nodes
+    size_t capacity() const { return m_config.maxNodes; }
+
+    /// Nodes that fit in `bytes` of arena
+    static size_t nodesForBudget(size_t bytes);
+
+private:
+    struct Node {
+        std::atomic<uint32_t> visits;      // Includes pending virtual visits
+        std::atomic<int64_t> valueSum;     // Fixed point, VALUE_SCALE per unit
+        std::atomic<uint32_t> firstChild;  // Arena index of the child block (0 = none)
+        std::atomic<uint8_t> state;        // NODE_LEAF / NODE_EXPANDING / NODE_EXPANDED
+        float prior;
+    };
+
+    uint32_t allocateChildren();
+    void resetNode(Node& node, float prior);
+    void runWorker(const BattleEngine& root, size_t worker);
+    void determinize(BattleEngine& engine, uint32_t seed) const;
+    float evaluateLeaf(BattleEngine& engine, float* priors) const;
+    float evaluateLeafShared(BattleEngine& engine, float* priors) const;
+    int selectChild(const Node& parent, const Action* legal, int count) const;
+
+    MctsConfig m_config;
+    std::unique_ptr<Node[]> m_nodes;
+    std::atomic<uint32_t> m_nextNode{0};
+    std::unique_ptr<ThreadPool> m_pool;
+
+    // Per-search budget
+    std::atomic<uint32_t> m_iterationsStarted{0};
+    std::atomic<uint32_t> m_iterationsDone{0};
+    std::chrono::steady_clock::time_point m_deadline;
+};
+
+}  // namespace pkmn
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "battle_engine.hpp"
+#include <cstdint>
+
+namespace pkmn {
+
+// ============================================================================
+// Observations
+//
+// Native version of PokemonEnv._get_obs (pybattle/pkmn_env.py), so batch
+// recorders and dataset tools produce the same features as the Gymnasium
+// wrapper without a round trip through Python. Layout, from `side`'s view:
+//   [0, 2)   active HP fraction (own, foe)
+//   [2, 4)   active species / 412 (own, foe)
+//   [4, 11)  own stat stages / 6, [11, 18) foe stat stages / 6
+//   [18, 22) own move ids / 355, [22, 26) own PP / 40
+//   [26, 28) reserved (status), always 0
+//   [28, 30) mons remaining / 3 (own, foe)
+// ============================================================================
+
+constexpr int OBS_SIZE = 30;
+
+/// Encode `state` from `side`'s point of view into OBS_SIZE floats
+void encodeObservation(const BattleState& state, uint8_t side, float* out);
+
+/// out[t] = 1 if ActionType t is legal for `side`, else 0 (NUM_ACTION_TYPES bytes)
+void encodeActionMask(const BattleEngine& engine, uint8_t side, uint8_t* out);
+
+}  // namespace pkmn
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Phase scopes are compiled in for counters, for tracing (trace.hpp), or both
+#if defined(PKMN_PERF_COUNTERS) || defined(PKMN_TRACE_EVENTS)
+#define PKMN_PERF_SCOPES
+#endif
+
+#if defined(PKMN_PERF_SCOPES) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#elif defined(PKMN_PERF_SCOPES) && defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(PKMN_PERF_SCOPES)
+#include <chrono>
+#endif
+
+namespace pkmn {
+
+// ============================================================================
+// Hot-Path Phase Timers
+//
+// Call counts and elapsed ticks for the phases of a turn, compiled in only
+// with PKMN_PERF_COUNTERS (CMake option PERF_COUNTERS); otherwise
+// PKMN_PERF_SCOPE expands to nothing. Each thread writes its own cache-line
+// block with plain relaxed stores and the reader sums the blocks, so timing
+// takes no locks and no atomic read-modify-writes. Phases nest (Damage runs
+// inside ExecuteMove and AIDecision, everything inside Turn), so times are
+// inclusive and don't add up. With PKMN_TRACE_EVENTS the same scopes also
+// record trace events.
+// ============================================================================
+
+enum class PerfPhase : uint8_t {
+    Turn,        // BattleEngine::executeTurn
+    TurnOrder,   // determineTurnOrder
+    AIDecision,  // chooseAIAction
+    ExecuteMove,
+    Damage,      // calculateDamageWithRolls (engine, AI and policies)
+    EndOfTurn,   // applyEndOfTurnEffects
+};
+constexpr int PERF_PHASE_COUNT = 6;
+
+struct PerfCounter {
+    uint64_t calls = 0;
+    uint64_t ticks = 0;
+    double seconds = 0.0;  // ticks converted with perfTicksPerSecond()
+};
+
+struct PerfCounters {
+    std::array<PerfCounter, PERF_PHASE_COUNT> phases{};
+
+    const PerfCounter& operator[](PerfPhase phase) const { return phases[static_cast<int>(phase)]; }
+};
+
+/// Whether the library was built with PKMN_PERF_COUNTERS
+bool perfCountersEnabled();
+
+/// Snake-case phase name ("turn_order", ...)
+const char* perfPhaseName(PerfPhase phase);
+
+/// Totals over every thread, live and exited. Safe while other threads run;
+/// their in-flight updates may or may not be included.
+PerfCounters getPerfCounters();
+
+/// Zero every counter (updates racing with the reset may survive it)
+void resetPerfCounters();
+
+/// Tick rate, calibrated against steady_clock on first use
+double perfTicksPerSecond();
+
+#ifdef PKMN_PERF_SCOPES
+
+inline uint64_t perfTicks() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_MSC_VER)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/// Add one call of `ticks` to the calling thread's counters
+void perfRecord(PerfPhase phase, uint64_t ticks);
+
+/// Trace event for a phase while a trace is running (trace.cpp)
+void traceRecordPhase(PerfPhase phase, uint64_t startTicks, uint64_t endTicks);
+
+class PerfScope {
+public:
+    explicit PerfScope(PerfPhase phase) : m_phase(phase), m_start(perfTicks()) {}
+    ~PerfScope() {
+        const uint64_t end = perfTicks();
+#ifdef PKMN_PERF_COUNTERS
+        perfRecord(m_phase, end - m_start);
+#endif
+#ifdef PKMN_TRACE_EVENTS
+        traceRecordPhase(m_phase, m_start, end);
+#endif
+        (void)end;
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    PerfPhase m_phase;
+    uint64_t m_start;
+};
+
+#define PKMN_PERF_CONCAT_(a, b) a##b
+#define PKMN_PERF_CONCAT(a, b) PKMN_PERF_CONCAT_(a, b)
+#define PKMN_PERF_SCOPE(phase) ::pkmn::PerfScope PKMN_PERF_CONCAT(pkmnPerfScope, __LINE__)(phase)
+
+#else
+
+#define PKMN_PERF_SCOPE(phase) ((void)0)
+
+#endif
+
+}  // namespace pkmn
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "battle_engine.hpp"
+
+namespace pkmn {
+
+// ============================================================================
+// Policies
+//
+// Action selection for either side, shared by the engine's opponent, the
+// evaluators and search. Every policy is allocation-free; everything except
+// ScriptedAI is cheap enough for rollouts. PolicyKind and Policy live in
+// types.hpp.
+// ============================================================================
+
+/// Choose an action for `side` under the given policy
+Action choosePolicyAction(BattleEngine& engine, uint8_t side, const Policy& policy);
+
+/// Play the battle out with `playerPolicy` for side 0 (the engine's step()
+/// picks the opponent's action with its opponent policy) until it ends or
+/// reaches maxTurns.
+/// Returns the winner, or -1 if the turn cap was hit.
+int playOut(BattleEngine& engine, PolicyKind playerPolicy, uint16_t maxTurns);
+
+/// Play the battle out with a policy on each side via stepBoth (self-play)
+int playOut(BattleEngine& engine, PolicyKind playerPolicy, PolicyKind opponentPolicy, uint16_t maxTurns);
+
+/// Player's result in [0, 1]: 1 = win, 0 = loss, 0.5 = unfinished
+float outcomeValue(const BattleEngine& engine);
+
+}  // namespace pkmn
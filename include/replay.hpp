@@ -0,0 +1,140 @@
+#pragma once
+
+#include "battle_engine.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace pkmn {
+
+// ============================================================================
+// Replays
+//
+// A battle is fully determined by its seed and RNG mode, both teams, the
+// opponent policy and the player's actions, so a replay stores only those
+// plus the low 16 bits of the state hash after every turn: 24 bytes of header
+// (40 in counter mode) and 3 bytes per turn. Re-simulating a replay and
+// comparing hashes pins down the first turn on which the engine's behaviour
+// changed.
+//
+// File layout (little endian):
+//   ReplayFileHeader
+//   per replay: ReplayRecordHeader, [uint64_t rngKey, uint64_t rngCounter],
+//               uint8_t actions[turns], uint16_t hashChecks[turns]
+// An action byte is the player's ActionType, with the opponent's in the high
+// nibble for replays recorded with stepBoth (REPLAY_BOTH_SIDES). The counter
+// stream follows the record header only for RngMode::Counter replays, whose
+// key may have been set with seedCounterRng rather than by reset(seed).
+// Hash checks are only comparable under one definition of the state hash, so
+// the version changes with it and files of other versions are rejected.
+// ============================================================================
+
+constexpr uint32_t REPLAY_VERSION = 3;
+constexpr uint8_t REPLAY_BOTH_SIDES = 0x01;
+
+struct ReplayFileHeader {
+    char magic[4];     // "PBRP"
+    uint32_t version;  // REPLAY_VERSION
+};
+static_assert(sizeof(ReplayFileHeader) == 8, "ReplayFileHeader must stay 8 bytes");
+
+struct ReplayRecordHeader {
+    uint32_t seed;
+    uint16_t teamIds[6];     // FRONTIER_MONS ids: player 0-2, opponent 3-5
+    uint16_t turns;
+    uint8_t level;
+    uint8_t flags;           // REPLAY_BOTH_SIDES
+    uint8_t opponentPolicy;  // PolicyKind (unused with REPLAY_BOTH_SIDES)
+    uint8_t opponentIndex;   // Policy::actionIndex
+    int8_t winner;           // -1 if the battle didn't finish
+    uint8_t rngMode;         // RngMode
+};
+static_assert(sizeof(ReplayRecordHeader) == 24, "ReplayRecordHeader must stay 24 bytes");
+
+struct Replay {
+    uint32_t seed = 0;
+    std::array<uint16_t, 6> teamIds{};
+    uint8_t level = 50;
+    Policy opponentPolicy;
+    bool bothSides = false;
+    int8_t winner = -1;
+    RngMode rngMode = RngMode::GameLCG;
+    uint64_t rngKey = 0;               // Counter stream at the first turn (RngMode::Counter only)
+    uint64_t rngCounter = 0;
+    std::vector<uint8_t> actions;      // One per turn
+    std::vector<uint16_t> hashChecks;  // Low 16 bits of BattleState::hash after each turn
+};
+
+/// Reset `engine` to the start of `replay`: seed, RNG mode and counter
+/// stream, teams and opponent policy
+void startReplay(BattleEngine& engine, const Replay& replay);
+
+/// Step `engine` and append the turn to `replay` (winner is kept current).
+/// The first turn also records the engine's RNG mode and counter stream, so
+/// setRngMode and seedCounterRng may be called between startReplay and it.
+/// Choose actions without drawing on the engine's RNG (PolicyKind::Random
+/// does), or re-simulation will diverge.
+StepResult recordStep(BattleEngine& engine, Replay& replay, Action playerAction);
+StepResult recordStepBoth(BattleEngine& engine, Replay& replay, Action playerAction, Action opponentAction);
+
+struct ReplayVerification {
+    int divergedTurn = -1;  // First turn whose hash didn't match, or -1
+    bool winnerMatches = true;
+    uint16_t turns = 0;     // Turns re-simulated
+
+    bool ok() const { return divergedTurn < 0 && winnerMatches; }
+};
+
+/// Re-simulate `replay`, stopping at the first hash mismatch
+ReplayVerification verifyReplay(const Replay& replay);
+
+/// verifyReplay over many replays in parallel (numThreads = 0 uses all hardware threads)
+std::vector<ReplayVerification> verifyReplays(const std::vector<Replay>& replays, size_t numThreads = 0);
+
+/// Appends replays to a new file. Throws std::runtime_error on IO errors.
+class ReplayWriter {
+public:
+    explicit ReplayWriter(const std::string& path);
+    ~ReplayWriter();
+
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+    void write(const Replay& replay);
+
+    /// Flush and close; further writes throw
+    void close();
+
+    size_t count() const { return m_count; }
+
+private:
+    std::FILE* m_file = nullptr;
+    std::string m_path;
+    size_t m_count = 0;
+};
+
+/// Streams replays from a file. Throws std::runtime_error if the file is
+/// missing, malformed or truncated.
+class ReplayReader {
+public:
+    explicit ReplayReader(const std::string& path);
+    ~ReplayReader();
+
+    ReplayReader(const ReplayReader&) = delete;
+    ReplayReader& operator=(const ReplayReader&) = delete;
+
+    /// Read the next replay into `out`; false at the end of the file
+    bool next(Replay& out);
+
+private:
+    std::FILE* m_file = nullptr;
+    std::string m_path;
+};
+
+/// Every replay in a file
+std::vector<Replay> readReplays(const std::string& path);
+
+}  // namespace pkmn
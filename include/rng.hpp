@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pkmn {
+
+// ============================================================================
+// Seed Derivation
+//
+// Simulation jobs (tables, evaluators, search) need many independent battle
+// seeds derived from one base seed. SplitMix64 finalizer: cheap, stateless,
+// and well mixed even for consecutive inputs.
+// ============================================================================
+
+constexpr uint64_t splitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/// 32-bit battle seed for item `index` of stream `stream` under `baseSeed`
+inline uint32_t deriveSeed(uint64_t baseSeed, uint64_t stream, uint64_t index = 0) {
+    uint64_t h = splitMix64(baseSeed ^ splitMix64(stream ^ splitMix64(index)));
+    return static_cast<uint32_t>(h >> 32);
+}
+
+// ============================================================================
+// LCG Jump-Ahead
+//
+// Both game generators are 32-bit LCGs: the battle engine uses pokeemerald's
+// gRngValue (BattleEngine::random) and FactoryGenerator the C library's
+// rand() constants. Composing the affine step with itself by squaring skips
+// n draws in O(log n). Both have full period 2^32, so stepping back k draws
+// is a jump of 2^32 - k.
+// ============================================================================
+
+constexpr uint32_t EMERALD_RNG_MULT = 1103515245u;
+constexpr uint32_t EMERALD_RNG_INC = 24691u;
+constexpr uint32_t FACTORY_RNG_MULT = 1103515245u;
+constexpr uint32_t FACTORY_RNG_INC = 12345u;
+
+/// State of x -> mult * x + inc (mod 2^32) after `steps` steps from `state`
+constexpr uint32_t lcgJump(uint32_t state, uint64_t steps, uint32_t mult, uint32_t inc) {
+    uint32_t accMult = 1, accInc = 0;
+    while (steps) {
+        if (steps & 1) {
+            accMult *= mult;
+            accInc = accInc * mult + inc;
+        }
+        inc = (mult + 1) * inc;
+        mult *= mult;
+        steps >>= 1;
+    }
+    return accMult * state + accInc;
+}
+
+/// Battle RNG state after `draws` calls to BattleEngine::random
+constexpr uint32_t emeraldRngJump(uint32_t state, uint64_t draws) {
+    return lcgJump(state, draws, EMERALD_RNG_MULT, EMERALD_RNG_INC);
+}
+
+/// FactoryGenerator seed after `draws` draws
+constexpr uint32_t factoryRngJump(uint32_t seed, uint64_t draws) {
+    return lcgJump(seed, draws, FACTORY_RNG_MULT, FACTORY_RNG_INC);
+}
+
+// ============================================================================
+// Counter-Based RNG
+//
+// Alternative battle RNG for sharded and batched runs (RngMode::Counter):
+// draw i of stream `key` is a pure function of (key, i), the top 16 bits of
+// the SplitMix64 sequence started at `key`. Streams keyed by (global seed,
+// env, episode) don't depend on thread scheduling or on other environments,
+// any draw can be computed directly, and many streams can be advanced at
+// once with plain 64-bit arithmetic. Not game-accurate; the LCG stays the
+// default.
+// ============================================================================
+
+enum class RngMode : uint8_t {
+    GameLCG,  // pokeemerald's LCG
+    Counter,  // counterRandom
+};
+
+constexpr uint64_t COUNTER_RNG_GAMMA = 0x9E3779B97F4A7C15ull;
+
+/// Draw `counter` of stream `key`
+constexpr uint16_t counterRandom(uint64_t key, uint64_t counter) {
+    return static_cast<uint16_t>(splitMix64(key + counter * COUNTER_RNG_GAMMA) >> 48);
+}
+
+/// Stream key for environment `env`'s episode `episode` under `globalSeed`
+constexpr uint64_t counterRngKey(uint64_t globalSeed, uint64_t env, uint64_t episode) {
+    return splitMix64(globalSeed ^ splitMix64(env ^ splitMix64(episode)));
+}
+
+/// out[i] = counterRandom(keys[i], counters[i]) for structure-of-arrays
+/// streams; branch-free so the loop vectorizes
+void counterRandomBatch(const uint64_t* keys, const uint64_t* counters, uint16_t* out, size_t count);
+
+// ============================================================================
+// RNG Draw Trace
+//
+// Optional log of every battle RNG draw with the turn it happened on and the
+// call site that asked for it, to find wasted draws and to check batched
+// engines against the scalar one draw for draw. Compiled in only with
+// PKMN_RNG_TRACE (CMake option RNG_TRACE). Draws are appended to the vector
+// set for the drawing thread, from whichever engine draws on it, including
+// the copies lookahead and AI scoring make.
+// ============================================================================
+
+enum class RngTag : uint8_t {
+    Other,
+    SpeedTie,
+    Accuracy,
+    Crit,
+    DamageRoll,
+    AIScript,    // Random checks in AI scripts
+    AITieBreak,  // chooseAIAction picking among equal scores
+    Policy,      // PolicyKind::Random
+};
+constexpr int RNG_TAG_COUNT = 8;
+
+struct RngDraw {
+    uint16_t turn;
+    uint16_t value;  // random()'s result
+    RngTag tag;
+};
+
+const char* rngTagName(RngTag tag);
+
+/// Whether the library was built with PKMN_RNG_TRACE
+bool rngTraceEnabled();
+
+/// Append the calling thread's draws to `out` until set to nullptr
+void setRngTrace(std::vector<RngDraw>* out);
+
+#ifdef PKMN_RNG_TRACE
+void rngTraceRecord(RngTag tag, uint16_t turn, uint16_t value);
+#endif
+
+}  // namespace pkmn
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pkmn {
+
+// ============================================================================
+// Thread Pool
+//
+// Persistent workers for data-parallel loops over battles. Work is handed out
+// in `grain`-sized chunks from an atomic cursor, so long battles don't leave
+// the other threads idle at the end of a batch. The calling thread takes part
+// as worker 0.
+// ============================================================================
+class ThreadPool {
+public:
+    /// fn(begin, end, workerIndex) processes items [begin, end)
+    using RangeFn = std::function<void(size_t, size_t, size_t)>;
+
+    /// numThreads = 0 uses std::thread::hardware_concurrency()
+    explicit ThreadPool(size_t numThreads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Total number of threads taking part in a loop (workers + caller)
+    size_t size() const { return m_workers.size() + 1; }
+
+    /// Run fn over [0, count) and block until every item is done. If fn
+    /// throws, the chunks not yet started are skipped and the first
+    /// exception is rethrown once every thread has returned from fn.
+    void parallelFor(size_t count, size_t grain, const RangeFn& fn);
+
+    /// Resolve a requested thread count (0 = all hardware threads)
+    static size_t resolveThreadCount(size_t requested);
+
+private:
+    void workerLoop(size_t workerIndex);
+    void runChunks(size_t workerIndex);
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    uint64_t m_generation = 0;
+    size_t m_pending = 0;
+    bool m_stop = false;
+
+    // Current job
+    const RangeFn* m_fn = nullptr;
+    size_t m_count = 0;
+    size_t m_grain = 1;
+    std::atomic<size_t> m_next{0};
+    std::exception_ptr m_error;  // First exception thrown by fn
+};
+
+/// One-off parallel loop on temporary threads (for batch jobs outside a
+/// pool); exceptions from fn propagate as in ThreadPool::parallelFor
+void parallelFor(size_t count, size_t numThreads, size_t grain, const ThreadPool::RangeFn& fn);
+
+}  // namespace pkmn
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "perf_counters.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pkmn {
+
+// ============================================================================
+// Trace Events
+//
+// Optional timeline of engine work for chrome://tracing and Perfetto:
+// turn phases (the PKMN_PERF_SCOPE sites), AI script runs, thread pool
+// chunks and VecBattleEnv environment steps. Compiled in only with
+// PKMN_TRACE_EVENTS (CMake option TRACE_EVENTS) and recorded only between
+// startTrace() and stopTrace(). Each thread appends complete (begin + end)
+// events to its own ring buffer of TRACE_BUFFER_EVENTS, overwriting its
+// oldest events when full; nothing is shared between writers, so recording
+// takes no locks. Threads get one buffer, and one timeline lane, each while
+// they live; exited threads' buffers are reused by new ones.
+// ============================================================================
+
+enum class TraceEvent : uint8_t {
+    // PerfPhase values first, so phase scopes map straight across
+    Turn,
+    TurnOrder,
+    AIDecision,
+    ExecuteMove,
+    Damage,
+    EndOfTurn,
+    AIScript,     // One AI script run: arg0 = logic id, arg1 = move slot
+    WorkerShard,  // One ThreadPool chunk: items [arg0, arg1)
+    EnvStep,      // One VecBattleEnv environment's step: arg0 = env index
+};
+constexpr int TRACE_EVENT_KINDS = 9;
+
+constexpr size_t TRACE_BUFFER_EVENTS = size_t(1) << 16;  // Per thread, power of two
+
+/// Whether the library was built with PKMN_TRACE_EVENTS
+bool traceEventsEnabled();
+
+/// Clear every buffer and start recording. Call between batches: events
+/// written while the buffers are cleared may survive.
+void startTrace();
+void stopTrace();
+bool traceRunning();
+
+/// Write the retained events as Chrome trace JSON (timestamps in us from
+/// startTrace) and return how many were written. Call after stopTrace().
+/// Throws std::runtime_error if the file can't be written.
+size_t writeChromeTrace(const std::string& path);
+
+#ifdef PKMN_TRACE_EVENTS
+
+/// Append one event to the calling thread's buffer while a trace is running
+void traceRecord(TraceEvent event, uint64_t startTicks, uint64_t endTicks, uint32_t arg0, uint32_t arg1);
+
+class TraceScope {
+public:
+    TraceScope(TraceEvent event, uint32_t arg0, uint32_t arg1)
+        : m_event(event), m_arg0(arg0), m_arg1(arg1), m_start(perfTicks()) {}
+    ~TraceScope() { traceRecord(m_event, m_start, perfTicks(), m_arg0, m_arg1); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceEvent m_event;
+    uint32_t m_arg0;
+    uint32_t m_arg1;
+    uint64_t m_start;
+};
+
+#define PKMN_TRACE_SCOPE(event, arg0, arg1)                                              \
+    ::pkmn::TraceScope PKMN_PERF_CONCAT(pkmnTraceScope, __LINE__)(                       \
+        event, static_cast<uint32_t>(arg0), static_cast<uint32_t>(arg1))
+
+#else
+
+#define PKMN_TRACE_SCOPE(event, arg0, arg1) ((void)0)
+
+#endif
+
+}  // namespace pkmn
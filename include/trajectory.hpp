@@ -0,0 +1,134 @@
+#pragma once
+
+#include "battle_engine.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pkmn {
+
+// ============================================================================
+// Trajectory Recorder
+//
+// Columnar dump of VecBattleEnv transitions for offline RL and imitation.
+// Every column is a headerless file of fixed-width little-endian records,
+// split into shards of at most rowsPerShard rows:
+//   <dir>/<column>.<shard, 6 digits>.bin
+//   <dir>/manifest.json  (columns, dtypes, shapes and rows per finished shard)
+// so each shard of each column opens directly as a numpy memmap
+// (pybattle/trajectory.py).
+//
+// The current shard is a writable memory mapping that rows are written into
+// in place. A background thread maps and pre-faults the next shard ahead of
+// time, and syncs, unmaps and trims full ones, so appending never waits on
+// disk unless the writer outruns the flusher by a whole shard.
+// ============================================================================
+
+constexpr uint32_t TRAJECTORY_VERSION = 1;
+constexpr size_t TRAJECTORY_DEFAULT_SHARD_ROWS = size_t(1) << 18;
+
+enum class TrajectoryColumn : uint8_t {
+    Obs,         // float32[OBS_SIZE], before the action (observation.hpp)
+    ActionMask,  // uint8[NUM_ACTION_TYPES], legal actions before the action
+    Action,      // uint8 ActionType taken
+    Reward,      // float32
+    Done,        // bool
+    AIScores,    // int8[4] scripted AI move scores before the action (optional)
+    Env,         // uint32 environment (or game) index the row came from
+};
+constexpr int TRAJECTORY_COLUMNS = 7;
+
+struct TrajectoryColumnInfo {
+    const char* name;   // File prefix and manifest key
+    const char* dtype;  // numpy dtype string
+    uint32_t width;     // Elements per row
+    uint32_t rowBytes;
+};
+
+const TrajectoryColumnInfo& trajectoryColumnInfo(TrajectoryColumn column);
+
+/// `count` consecutive rows of the current shard, one pointer per column
+/// (aiScores is null when the recorder doesn't keep AI scores)
+struct TrajectoryRows {
+    float* obs;
+    uint8_t* masks;
+    uint8_t* actions;
+    float* rewards;
+    bool* dones;
+    int8_t* aiScores;
+    uint32_t* envs;
+    size_t count;
+};
+
+/// Appends trajectories to a directory. Single writer: reserve() and
+/// recordStep() must not be called concurrently. Throws std::runtime_error
+/// on IO errors, including ones hit by the background flusher; those are
+/// sticky, so every later shard rotation and close() rethrows them, and the
+/// manifest keeps listing only the shards finished before the error.
+class TrajectoryRecorder {
+public:
+    explicit TrajectoryRecorder(const std::string& dir, size_t rowsPerShard = TRAJECTORY_DEFAULT_SHARD_ROWS,
+                                bool aiScores = true);
+    ~TrajectoryRecorder();
+
+    TrajectoryRecorder(const TrajectoryRecorder&) = delete;
+    TrajectoryRecorder& operator=(const TrajectoryRecorder&) = delete;
+
+    /// Space for `count` rows (at most rowsPerShard), starting a new shard if
+    /// the current one is too full. Pointers stay valid until the next
+    /// reserve() or close().
+    TrajectoryRows reserve(size_t count);
+
+    /// Observe every environment, step it with `actions` (step()) and append
+    /// one row per environment. Rewards and dones are also copied to the
+    /// caller's arrays when non-null.
+    void recordStep(VecBattleEnv& env, const Action* actions, float* rewards, bool* dones, size_t count);
+
+    /// Finish the current shard, wait for the flusher and write the final
+    /// manifest; further appends throw
+    void close();
+
+    uint64_t rows() const { return m_rows; }
+    size_t rowsPerShard() const { return m_rowsPerShard; }
+
+    /// Rows reserve() can still place in the current shard without starting
+    /// a new one; writers splitting a batch fill shards by reserving this many
+    size_t shardRowsLeft() const;
+    bool hasAIScores() const { return m_aiScores; }
+    const std::string& directory() const { return m_dir; }
+
+private:
+    struct Shard;
+
+    std::unique_ptr<Shard> openShard(size_t index) const;
+    void flusherLoop();
+    void writeManifest(const std::vector<uint64_t>& shardRows) const;
+
+    std::string m_dir;
+    size_t m_rowsPerShard;
+    bool m_aiScores;
+    uint64_t m_rows = 0;
+    bool m_closed = false;
+    std::unique_ptr<Shard> m_current;
+
+    // Shared with the flusher
+    std::mutex m_mutex;
+    std::condition_variable m_wake;   // Work for the flusher
+    std::condition_variable m_ready;  // A shard was prepared or retired
+    std::unique_ptr<Shard> m_next;
+    std::deque<std::unique_ptr<Shard>> m_retiring;
+    std::vector<uint64_t> m_finished;  // Rows per finished shard
+    size_t m_nextIndex = 0;
+    bool m_stop = false;
+    std::exception_ptr m_error;
+    std::thread m_flusher;
+};
+
+}  // namespace pkmn
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "types.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace pkmn {
+
+// ============================================================================
+// Transposition Table
+//
+// Fixed-size table of search results keyed by BattleState::hash, shared by
+// every thread of a search (and by several searches on the same root).
+// Buckets are one cache line of four entries. Entries are lock-free: each is
+// two words, (key ^ data) and data, written with relaxed stores, so a torn
+// write fails the XOR check and reads as a miss instead of as another
+// position's result. newGeneration() ages the table between searches;
+// stale entries are the first to be replaced.
+// ============================================================================
+
+enum class Bound : uint8_t {
+    None,   // Statistics only (MCTS leaf estimates)
+    Exact,
+    Lower,  // True value >= value (fail high)
+    Upper,  // True value <= value (fail low)
+};
+
+constexpr uint8_t TT_NO_ACTION = 0xF;
+constexpr uint32_t TT_MAX_VISITS = (1u << 20) - 1;
+constexpr uint8_t TT_GENERATIONS = 64;  // Generation counter wraps at this
+constexpr uint8_t TT_DEPTH_SOLVED = 0xFF;  // Depth of an exact value searched to the end of every line
+
+struct TTEntry {
+    float value = 0.5f;                 // Player's value in [0, 1], stored to 24 bits
+    uint32_t visits = 0;                // Samples behind value; saturates at TT_MAX_VISITS
+    uint8_t bestAction = TT_NO_ACTION;  // ActionType, or TT_NO_ACTION
+    uint8_t depth = 0;                  // Remaining turns the value was searched to, or TT_DEPTH_SOLVED
+    Bound bound = Bound::None;
+};
+
+class TranspositionTable {
+public:
+    /// Rounds down to a power-of-two number of buckets (at least one)
+    explicit TranspositionTable(size_t megabytes);
+    ~TranspositionTable();
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    /// Copy the entry for `key` into `out`; false on a miss. Thread-safe.
+    bool probe(uint64_t key, TTEntry& out) const;
+
+    /// Store over `key`'s entry, or else the bucket's emptiest or stalest
+    /// entry. Thread-safe; concurrent stores to one slot may lose one.
+    void store(uint64_t key, const TTEntry& entry);
+
+    /// Start a new search: older entries become preferred victims
+    void newGeneration();
+    uint8_t generation() const { return m_generation.load(std::memory_order_relaxed); }
+
+    /// Empty every entry (not thread-safe against concurrent searches)
+    void clear();
+
+    /// Entries the table holds
+    size_t capacity() const { return (m_mask + 1) * ENTRIES_PER_BUCKET; }
+    size_t sizeBytes() const { return (m_mask + 1) * sizeof(Bucket); }
+
+    /// Permille of a sample of entries written this generation
+    int hashfull() const;
+
+    /// Entries written this generation, counting every bucket (O(capacity))
+    size_t countUsed() const;
+
+private:
+    static constexpr int ENTRIES_PER_BUCKET = 4;
+
+    size_t countCurrent(size_t buckets) const;
+
+    struct alignas(64) Bucket {
+        std::atomic<uint64_t> check[ENTRIES_PER_BUCKET];  // key ^ data
+        std::atomic<uint64_t> data[ENTRIES_PER_BUCKET];
+    };
+    static_assert(sizeof(Bucket) == 64, "Bucket should fill one cache line");
+
+    std::unique_ptr<Bucket[]> m_buckets;
+    size_t m_mask;  // Bucket count - 1
+    std::atomic<uint8_t> m_generation{0};
+};
+
+}  // namespace pkmn
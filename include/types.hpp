@@ -264,6 +264,10 @@ struct BattleState {
     // Active battlers (singles: 1 each side)
     ActiveMon active[2];
     
+    // Party slots each side has sent out so far (bit i = slot i); the rest
+    // are hidden from the other side
+    uint8_t revealedMask[2];
+    
     // Field conditions
     Weather weather;
     uint8_t weatherTurns;
@@ -275,6 +279,10 @@ struct BattleState {
     // RNG state (for deterministic replay)
     uint32_t rngState;
     
+    // Zobrist hash of everything above except the RNG and revealed slots,
+    // kept current by BattleEngine (see zobrist.hpp)
+    uint64_t hash;
+    
     // Get the Pokemon reference for an active battler
     Pokemon& getActivePokemon(uint8_t side) {
         return teams[side][active[side].partyIndex];
@@ -286,6 +294,10 @@ struct BattleState {
     // Count remaining (non-fainted) mons
     uint8_t countRemaining(uint8_t side) const;
     
+    // Summed current / max HP over a side's team
+    int teamHP(uint8_t side) const;
+    int teamMaxHP(uint8_t side) const;
+    
     // Check if battle is over
     bool isTerminal() const;
     int getWinner() const;  // -1 if not terminal, 0 or 1 otherwise
@@ -300,6 +312,8 @@ enum class ActionType : uint8_t {
     Struggle,  // Forced when out of PP
 };
 
+constexpr int NUM_ACTION_TYPES = 10;
+
 struct Action {
     ActionType type;
     
@@ -309,6 +323,24 @@ struct Action {
     uint8_t getSwitchTarget() const { return static_cast<uint8_t>(type) - static_cast<uint8_t>(ActionType::Switch1); }
 };
 
+// ============================================================================
+// Policies (implemented in policy.cpp)
+// ============================================================================
+enum class PolicyKind : uint8_t {
+    ScriptedAI,  // Gen 3 Frontier AI scripts (chooseAIAction)
+    Random,      // Uniform over legal actions, drawn from the engine RNG
+    MaxDamage,   // Move with the highest expected damage (no crit, max roll x accuracy)
+    FixedIndex,  // legal[actionIndex], clamped to the last legal action
+};
+
+/// A policy and its parameters; cheap to copy into every engine
+struct Policy {
+    PolicyKind kind;
+    uint8_t actionIndex;  // FixedIndex only
+
+    constexpr Policy(PolicyKind k = PolicyKind::ScriptedAI, uint8_t index = 0) : kind(k), actionIndex(index) {}
+};
+
 // ============================================================================
 // Step Result
 // ============================================================================
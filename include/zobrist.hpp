@@ -0,0 +1,71 @@
+#pragma once
+
+#include "types.hpp"
+#include "constants.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace pkmn {
+
+// ============================================================================
+// Zobrist Hashing
+//
+// 64-bit state hash for transposition tables, caches and deduplication. The
+// hash is the XOR of one key per field value, so BattleEngine keeps
+// BattleState::hash current by XOR-ing out a field's old key and XOR-ing in
+// the new one wherever it writes the field. High-churn fields (HP,
+// PP, status, stat stages, active index, turn) index fixed random key tables;
+// rarely-changing packed fields (volatiles, screens, weather) and the teams'
+// identity are mixed with splitMix64. The RNG state and revealed slots
+// are not hashed, so positions reached through different draws collide.
+// ============================================================================
+
+constexpr int ZOBRIST_MAX_PP = 64;       // 40 base PP with three PP Ups
+constexpr int ZOBRIST_STATUS_KEYS = 16;  // Status values fit in 4 bits
+constexpr int ZOBRIST_STAGE_KEYS = 13;   // -6..+6
+
+struct ZobristTables {
+    uint64_t hpLow[2][MAX_PARTY_SIZE][256];
+    uint64_t hpHigh[2][MAX_PARTY_SIZE][256];
+    uint64_t pp[2][MAX_PARTY_SIZE][MAX_MOVES][ZOBRIST_MAX_PP + 1];
+    uint64_t status[2][MAX_PARTY_SIZE][ZOBRIST_STATUS_KEYS];
+    uint64_t partyIndex[2][MAX_PARTY_SIZE];
+    uint64_t stages[2][BATTLE_STAT_COUNT][ZOBRIST_STAGE_KEYS];
+    uint64_t turnLow[256];
+    uint64_t turnHigh[256];
+};
+
+/// Fixed random keys (defined in zobrist.cpp)
+extern const ZobristTables ZOBRIST_TABLES;
+
+/// Single-field keys, inline for the engine's per-write updates
+inline uint64_t zobristHP(uint8_t side, uint8_t slot, uint16_t hp) {
+    return ZOBRIST_TABLES.hpLow[side][slot][hp & 0xFF] ^ ZOBRIST_TABLES.hpHigh[side][slot][hp >> 8];
+}
+
+inline uint64_t zobristPP(uint8_t side, uint8_t slot, int move, uint8_t pp) {
+    return ZOBRIST_TABLES.pp[side][slot][move][std::min<int>(pp, ZOBRIST_MAX_PP)];
+}
+
+inline uint64_t zobristTurn(uint16_t turn) {
+    return ZOBRIST_TABLES.turnLow[turn & 0xFF] ^ ZOBRIST_TABLES.turnHigh[turn >> 8];
+}
+
+/// Party slot: current HP, PP and status
+uint64_t zobristMon(const Pokemon& mon, uint8_t side, uint8_t slot);
+
+/// Active battler: party index, stat stages and volatile status
+uint64_t zobristActive(const ActiveMon& active, uint8_t side);
+
+/// Field: weather and both sides' conditions
+uint64_t zobristField(const BattleState& state);
+
+/// One side's team (species, item, ability, level, moves and stats of each
+/// slot, plus zobristMon), team size and active battler; team setup rehashes
+/// just this
+uint64_t zobristSide(const BattleState& state, uint8_t side);
+
+/// Full recompute; equals BattleState::hash for engine-maintained states
+uint64_t zobristHash(const BattleState& state);
+
+}  // namespace pkmn
@@ -11,3 +11,4 @@ except ImportError:
 
 from .pkmn_env import PokemonEnv
 from .factory_hrl_env import FactoryHRL_Env, FactoryPhase
+from .trajectory import TrajectoryDataset, read_manifest
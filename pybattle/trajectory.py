@@ -0,0 +1,58 @@
+"""
+Zero-copy reader for trajectories written by the native TrajectoryRecorder.
+
+A recording directory holds one raw file per column per shard plus a
+manifest.json; every shard of every column opens as a read-only numpy memmap,
+so nothing is loaded until it is indexed. Only finished shards are listed,
+so a recording can be read while it is still being written.
+"""
+import json
+import os
+
+import numpy as np
+
+
+def read_manifest(directory):
+    with open(os.path.join(directory, "manifest.json")) as f:
+        manifest = json.load(f)
+    if manifest["version"] != 1:
+        raise ValueError(f"Unsupported trajectory version {manifest['version']} in {directory}")
+    return manifest
+
+
+class TrajectoryDataset:
+    """
+    Shards of a recording as dicts of column name -> np.memmap with shape
+    [rows, *column_shape]:
+
+        data = TrajectoryDataset("runs/offline")
+        for shard in data.shards:
+            obs, actions = shard["obs"], shard["action"]
+        rewards = data.column("reward")  # list of memmaps, one per shard
+    """
+
+    def __init__(self, directory):
+        self.directory = directory
+        self.manifest = read_manifest(directory)
+        self.columns = {c["name"]: (np.dtype(c["dtype"]), tuple(c["shape"])) for c in self.manifest["columns"]}
+        self.shards = [self._open_shard(i, rows) for i, rows in enumerate(self.manifest["shards"])]
+
+    def _open_shard(self, index, rows):
+        shard = {}
+        for name, (dtype, shape) in self.columns.items():
+            path = os.path.join(self.directory, f"{name}.{index:06d}.bin")
+            shard[name] = np.memmap(path, dtype=dtype, mode="r", shape=(rows,) + shape)
+        return shard
+
+    def __len__(self):
+        return sum(self.manifest["shards"])
+
+    def column(self, name):
+        return [shard[name] for shard in self.shards]
+
+    def concatenate(self, name):
+        """One array for a column (copies; the per-shard memmaps don't)."""
+        if not self.shards:
+            dtype, shape = self.columns[name]
+            return np.empty((0,) + shape, dtype=dtype)
+        return np.concatenate(self.column(name))
@@ -16,7 +16,8 @@ class CMakeBuild(build_ext):
             f"-DCMAKE_LIBRARY_OUTPUT_DIRECTORY={extdir}",
             f"-DPYTHON_EXECUTABLE={sys.executable}",
             "-DBUILD_PYTHON_BINDINGS=ON",
-            "-DBUILD_TESTS=OFF"
+            "-DBUILD_TESTS=OFF",
+            "-DBUILD_TOOLS=OFF"
         ]
 
         if sys.platform == "darwin":
@@ -1,12 +1,13 @@
 #include "ai.hpp"
 #include "ai_context.hpp"
-#include <vector>
+#include "perf_counters.hpp"
 #include <algorithm>
 #include <iostream>
 
 namespace pkmn {
 
-Action chooseAIAction(BattleEngine& engine, uint8_t battlerID) {
+Action chooseAIAction(BattleEngine& engine, uint8_t battlerID, int8_t* scores) {
+    PKMN_PERF_SCOPE(PerfPhase::AIDecision);
     // 1. Setup Context
     // Target is opponent (singles only for now).
     // If battlerID=0 (Player), target=1. If 1, target=0.
@@ -16,18 +17,22 @@ Action chooseAIAction(BattleEngine& engine, uint8_t battlerID) {
     // 2. Initialize scores
     const auto& mon = engine.getState().getActivePokemon(battlerID);
     
-    std::vector<uint8_t> validMoves;
+    // Fixed arrays rather than vectors: playouts call this every simulated turn
+    uint8_t validMoves[4];
+    int numValid = 0;
     for (int i=0; i<4; ++i) {
         if (mon.moves[i] != 0 && mon.pp[i] > 0) {
             ctx.aiThinking.score[i] = 100;
-            validMoves.push_back(i);
+            validMoves[numValid++] = i;
         } else {
             ctx.aiThinking.score[i] = 0;
         }
     }
     
+    if (scores) std::fill(scores, scores + 4, 0);
+
     // If no moves, Struggle (handled by returning Struggle action or let engine handle it)
-    if (validMoves.empty()) {
+    if (numValid == 0) {
         Action a; 
         a.type = ActionType::Struggle; // Should be handled by engine if index is special?
         // ActionType enum has Struggle? Yes.
@@ -49,7 +54,8 @@ Action chooseAIAction(BattleEngine& engine, uint8_t battlerID) {
     
     // Phase 1: Check Bad Move (Script 0)
     if (runCheckBadMove) {
-        for (uint8_t i : validMoves) {
+        for (int v = 0; v < numValid; v++) {
+            uint8_t i = validMoves[v];
             if (ctx.aiThinking.score[i] == 0) continue;
             
             ctx.aiThinking.movesetIndex = i;
@@ -60,7 +66,8 @@ Action chooseAIAction(BattleEngine& engine, uint8_t battlerID) {
     
     // Phase 2: Viability (Script 2)
     if (runViability) {
-        for (uint8_t i : validMoves) {
+        for (int v = 0; v < numValid; v++) {
+            uint8_t i = validMoves[v];
             if (ctx.aiThinking.score[i] == 0) continue;
             
             ctx.aiThinking.movesetIndex = i;
@@ -71,7 +78,8 @@ Action chooseAIAction(BattleEngine& engine, uint8_t battlerID) {
     
     // Phase 3: Try To Faint (Script 1)
     if (runTryToFaint) {
-        for (uint8_t i : validMoves) {
+        for (int v = 0; v < numValid; v++) {
+            uint8_t i = validMoves[v];
             if (ctx.aiThinking.score[i] == 0) continue;
             
             ctx.aiThinking.movesetIndex = i;
@@ -82,7 +90,8 @@ Action chooseAIAction(BattleEngine& engine, uint8_t battlerID) {
     
     // Phase 4: Setup First Turn (Script 3)
     if (runSetupFirstTurn) {
-         for (uint8_t i : validMoves) {
+         for (int v = 0; v < numValid; v++) {
+            uint8_t i = validMoves[v];
             if (ctx.aiThinking.score[i] == 0) continue;
             
             ctx.aiThinking.movesetIndex = i;
@@ -91,26 +100,29 @@ Action chooseAIAction(BattleEngine& engine, uint8_t battlerID) {
         }
     }
 
+    if (scores) std::copy(ctx.aiThinking.score, ctx.aiThinking.score + 4, scores);
+
     // 4. Pick best move
     int bestScore = -1;
     
-    for (uint8_t i : validMoves) {
+    for (int v = 0; v < numValid; v++) {
+        uint8_t i = validMoves[v];
         if (ctx.aiThinking.score[i] > bestScore) {
             bestScore = ctx.aiThinking.score[i];
         }
     }
     
     // Collect ties
-    std::vector<int> ties;
-    for (uint8_t i : validMoves) {
-        if (ctx.aiThinking.score[i] == bestScore) ties.push_back(i);
+    uint8_t ties[4];
+    int numTies = 0;
+    for (int v = 0; v < numValid; v++) {
+        if (ctx.aiThinking.score[validMoves[v]] == bestScore) ties[numTies++] = validMoves[v];
     }
     
     int bestMoveIdx = -1;
-    if (!ties.empty()) {
+    if (numTies > 0) {
         // Deterministic random from engine?
-        // engine.random() returns uint32_t
-        bestMoveIdx = ties[engine.random() % ties.size()];
+        bestMoveIdx = ties[engine.random(RngTag::AITieBreak) % numTies];
     }
     
     Action action;
@@ -29,11 +29,11 @@ void AIContext::scoreOp(int val) {
 }
 
 bool AIContext::randomLessThan(uint8_t val) {
-    return (engine.random() % 256) < val;
+    return (engine.random(RngTag::AIScript) % 256) < val;
 }
 
 bool AIContext::randomGreaterThan(uint8_t val) {
-    return (engine.random() % 256) > val;
+    return (engine.random(RngTag::AIScript) % 256) > val;
 }
 
 bool AIContext::hpLessThan(uint8_t battlerId, uint8_t percent) {
@@ -2,6 +2,8 @@
 #include "ai_scripts.hpp"
 #include "battle_engine.hpp"
 #include "data.hpp"
+#include "trace.hpp"
+#include <atomic>
 #include <iostream>
 
 namespace pkmn {
@@ -24,13 +26,14 @@ static uint32_t readInt(const uint8_t*& ptr) {
 }
 
 void AIContext::execute(uint32_t logicId) {
+    PKMN_TRACE_SCOPE(TraceEvent::AIScript, logicId, aiThinking.movesetIndex);
     // Lookup script
     uint32_t offset = gBattleAI_ScriptsTable[logicId];
     // offset 0 is "start of array". logic 0 is CheckBadMove.
     
     const uint8_t* ptr = gBattleAI_Scripts + offset;
     
-    stack.clear();
+    stackSize = 0;
     aiThinking.aiAction = 0;
     
     int instructions = 0;
@@ -60,7 +63,7 @@ void AIContext::execute(uint32_t logicId) {
                 // Decomp: if (random % 256 == val)
                 uint8_t val = readByte(ptr);
                 uint32_t target = readInt(ptr);
-                bool eq = ((engine.random() % 256) == val);
+                bool eq = ((engine.random(RngTag::AIScript) % 256) == val);
                 if (opcode == 0x02) { if (eq) ptr = gBattleAI_Scripts + target; }
                 else { if (!eq) ptr = gBattleAI_Scripts + target; }
                 break;
@@ -391,7 +394,11 @@ void AIContext::execute(uint32_t logicId) {
             {
                 uint32_t target = readInt(ptr);
                 uint32_t returnOffset = (uint32_t)(ptr - gBattleAI_Scripts);
-                stack.push_back(returnOffset);
+                if (stackSize == STACK_SIZE) {
+                    aiThinking.aiAction |= AI_ACTION_DONE;  // Nesting the game's scripts never reach
+                    break;
+                }
+                stack[stackSize++] = returnOffset;
                 ptr = gBattleAI_Scripts + target;
                 break;
             }
@@ -403,12 +410,10 @@ void AIContext::execute(uint32_t logicId) {
             }
             case 0x5A: // end
             {
-                if (stack.empty()) {
+                if (stackSize == 0) {
                     aiThinking.aiAction |= AI_ACTION_DONE;
                 } else {
-                    uint32_t ret = stack.back();
-                    stack.pop_back();
-                    ptr = gBattleAI_Scripts + ret;
+                    ptr = gBattleAI_Scripts + stack[--stackSize];
                 }
                 break;
             }
@@ -438,7 +443,10 @@ void AIContext::execute(uint32_t logicId) {
                 // Ideally we implement everything.
                 // Use OP_PARAMS from script?
                 // For now, logging error and stop.
-                std::cerr << "Unimplemented opcode: " << (int)opcode << std::endl;
+                // Warn once per opcode: this runs every AI decision in bulk simulation.
+                static std::atomic<bool> warned[256];
+                if (!warned[opcode].exchange(true, std::memory_order_relaxed))
+                    std::cerr << "Unimplemented opcode: " << (int)opcode << std::endl;
                 aiThinking.aiAction |= AI_ACTION_DONE;
                 break;
             }
@@ -1,23 +1,61 @@
 #include "battle_engine.hpp"
 #include "ai.hpp"
 #include "data.hpp"
+#include "factory.hpp"
+#include "lookahead.hpp"
+#include "observation.hpp"
+#include "perf_counters.hpp"
+#include "policy.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include "zobrist.hpp"
 #include "constants.hpp"
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 
 namespace pkmn {
 
 // ============================================================================
-// RNG (same LCG as the game)
+// RNG (same LCG as the game, or counter-based: rng.hpp)
 // ============================================================================
 
-uint16_t BattleEngine::random() {
-    // Same formula as pokeemerald: gRngValue = 1103515245 * gRngValue + 24691
-    m_state.rngState = 1103515245 * m_state.rngState + 24691;
-    return m_state.rngState >> 16;
+uint16_t BattleEngine::random(RngTag tag) {
+    uint16_t value;
+    if (m_rngMode == RngMode::Counter) {
+        value = counterRandom(m_rngKey, m_rngCounter++);
+    } else {
+        // Same formula as pokeemerald: gRngValue = 1103515245 * gRngValue + 24691
+        m_state.rngState = EMERALD_RNG_MULT * m_state.rngState + EMERALD_RNG_INC;
+        value = m_state.rngState >> 16;
+    }
+#ifdef PKMN_RNG_TRACE
+    rngTraceRecord(tag, m_state.turnNumber, value);
+#else
+    (void)tag;
+#endif
+    return value;
+}
+
+uint16_t BattleEngine::randomRange(uint16_t max, RngTag tag) {
+    return random(tag) % max;
+}
+
+bool BattleEngine::rollSpeedTie() {
+    return m_forcing ? m_forced.playerFirst : randomRange(2, RngTag::SpeedTie) == 0;
+}
+
+bool BattleEngine::rollAccuracy(int accuracy) {
+    return m_forcing ? m_forced.moves[m_forcedMove].hit : randomRange(100, RngTag::Accuracy) < accuracy;
 }
 
-uint16_t BattleEngine::randomRange(uint16_t max) {
-    return random() % max;
+bool BattleEngine::rollCrit(int critStage) {
+    if (m_forcing) return m_forced.moves[m_forcedMove].crit;
+    return randomRange(CRIT_CHANCE_DENOMINATORS[critStage], RngTag::Crit) < CRIT_CHANCE_NUMERATORS[critStage];
+}
+
+int BattleEngine::rollDamage() {
+    return m_forcing ? m_forced.moves[m_forcedMove].randFactor : 85 + randomRange(16, RngTag::DamageRoll);
 }
 
 // ============================================================================
@@ -25,6 +63,25 @@ uint16_t BattleEngine::randomRange(uint16_t max) {
 // ============================================================================
 
 int BattleEngine::calculateDamage(uint8_t attackerSide, uint8_t defenderSide, uint16_t moveId) {
+    const MoveData& move = getMoveData(moveId);
+    
+    if (move.power == 0) return 0;  // Status move
+    
+    // Critical hit check
+    int critStage = 0;  // TODO: Track crit stage from moves like Focus Energy
+    if (move.effect == MoveEffect::HIGH_CRITICAL) critStage++;
+    critStage = std::min(critStage, 4);
+    bool isCrit = rollCrit(critStage);
+    
+    // Random factor (85-100%)
+    int randFactor = rollDamage();
+    
+    return calculateDamageWithRolls(attackerSide, defenderSide, moveId, isCrit, randFactor);
+}
+
+int BattleEngine::calculateDamageWithRolls(uint8_t attackerSide, uint8_t defenderSide, uint16_t moveId,
+                                           bool isCrit, int randFactor) const {
+    PKMN_PERF_SCOPE(PerfPhase::Damage);
     const Pokemon& attacker = m_state.getActivePokemon(attackerSide);
     const Pokemon& defender = m_state.getActivePokemon(defenderSide);
     const ActiveMon& attackerActive = m_state.active[attackerSide];
@@ -63,19 +120,11 @@ int BattleEngine::calculateDamage(uint8_t attackerSide, uint8_t defenderSide, ui
     // Weather modifiers (simplified)
     // TODO: Full weather implementation
     
-    // Critical hit check
-    bool isCrit = false;
-    int critStage = 0;  // TODO: Track crit stage from moves like Focus Energy
-    if (move.effect == MoveEffect::HIGH_CRITICAL) critStage++;
-    critStage = std::min(critStage, 4);
-    
-    if (randomRange(CRIT_CHANCE_DENOMINATORS[critStage]) < CRIT_CHANCE_NUMERATORS[critStage]) {
-        isCrit = true;
+    if (isCrit) {
         damage = damage * 2;  // Gen 3: 2x multiplier
     }
     
     // Random factor (85-100%)
-    int randFactor = 85 + randomRange(16);  // 85 to 100
     damage = damage * randFactor / 100;
     
     // STAB (Same Type Attack Bonus)
@@ -125,7 +174,7 @@ BattleEngine::~BattleEngine() = default;
 
 void BattleEngine::reset(uint32_t seed) {
     m_state = BattleState{};
-    m_state.rngState = seed;
+    setRngState(seed);
     m_state.turnNumber = 0;
     m_state.weather = Weather::None;
     m_state.weatherTurns = 0;
@@ -135,9 +184,13 @@ void BattleEngine::reset(uint32_t seed) {
         m_state.active[i].reset();
         m_state.sides[i] = SideState{};
     }
+    // Every reset state hashes the same (the RNG isn't hashed)
+    static const uint64_t resetHash = zobristHash(m_state);
+    m_state.hash = resetHash;
 }
 
 void BattleEngine::setPlayerTeam(const Pokemon* mons, uint8_t count) {
+    m_state.hash ^= zobristSide(m_state, 0);
     count = std::min(count, static_cast<uint8_t>(MAX_PARTY_SIZE));
     m_state.teamSizes[0] = count;
     for (uint8_t i = 0; i < count; i++) {
@@ -145,9 +198,12 @@ void BattleEngine::setPlayerTeam(const Pokemon* mons, uint8_t count) {
     }
     m_state.active[0].partyIndex = 0;
     m_state.active[0].reset();
+    m_state.revealedMask[0] = 1;
+    m_state.hash ^= zobristSide(m_state, 0);
 }
 
 void BattleEngine::setOpponentTeam(const Pokemon* mons, uint8_t count) {
+    m_state.hash ^= zobristSide(m_state, 1);
     count = std::min(count, static_cast<uint8_t>(MAX_PARTY_SIZE));
     m_state.teamSizes[1] = count;
     for (uint8_t i = 0; i < count; i++) {
@@ -155,6 +211,15 @@ void BattleEngine::setOpponentTeam(const Pokemon* mons, uint8_t count) {
     }
     m_state.active[1].partyIndex = 0;
     m_state.active[1].reset();
+    m_state.revealedMask[1] = 1;
+    m_state.hash ^= zobristSide(m_state, 1);
+}
+
+void BattleEngine::setPartyMember(uint8_t side, uint8_t slot, const Pokemon& mon) {
+    if (side > 1 || slot >= m_state.teamSizes[side]) return;
+    m_state.hash ^= zobristSide(m_state, side);
+    m_state.teams[side][slot] = mon;
+    m_state.hash ^= zobristSide(m_state, side);
 }
 
 // ============================================================================
@@ -162,41 +227,45 @@ void BattleEngine::setOpponentTeam(const Pokemon* mons, uint8_t count) {
 // ============================================================================
 
 std::vector<Action> BattleEngine::getLegalActions() const {
-    std::vector<Action> actions;
-    const Pokemon& active = m_state.getActivePokemon(0);
+    Action buf[MAX_LEGAL_ACTIONS];
+    int count = getLegalActions(0, buf);
+    return std::vector<Action>(buf, buf + count);
+}
+
+int BattleEngine::getLegalActions(uint8_t side, Action* out) const {
+    int count = 0;
+    const Pokemon& active = m_state.getActivePokemon(side);
     
     // Check moves
     bool hasUsableMove = false;
     for (int i = 0; i < MAX_MOVES; i++) {
         if (active.moves[i] != MOVE_NONE && active.pp[i] > 0) {
-            actions.push_back(Action{static_cast<ActionType>(i)});
+            out[count++] = Action{static_cast<ActionType>(i)};
             hasUsableMove = true;
         }
     }
     
     // If no usable moves, Struggle is the only option
     if (!hasUsableMove) {
-        actions.push_back(Action{ActionType::Struggle});
-        return actions;
+        out[count++] = Action{ActionType::Struggle};
+        return count;
     }
     
     // Check switches
-    for (uint8_t i = 0; i < m_state.teamSizes[0]; i++) {
-        if (i != m_state.active[0].partyIndex && m_state.teams[0][i].currentHP > 0) {
-            actions.push_back(Action{static_cast<ActionType>(static_cast<int>(ActionType::Switch1) + i)});
+    for (uint8_t i = 0; i < m_state.teamSizes[side]; i++) {
+        if (i != m_state.active[side].partyIndex && m_state.teams[side][i].currentHP > 0) {
+            out[count++] = Action{static_cast<ActionType>(static_cast<int>(ActionType::Switch1) + i)};
         }
     }
     
-    return actions;
+    return count;
 }
 
 // ============================================================================
 // Turn Execution
 // ============================================================================
 
-BattleEngine::TurnOrder BattleEngine::determineTurnOrder(Action playerAction, Action opponentAction) {
-    TurnOrder order;
-    
+int BattleEngine::compareTurnOrder(Action playerAction, Action opponentAction) const {
     int playerPriority = 0, opponentPriority = 0;
     int playerSpeed = m_state.getActivePokemon(0).stats[Stat::Speed];
     int opponentSpeed = m_state.getActivePokemon(1).stats[Stat::Speed];
@@ -226,16 +295,18 @@ BattleEngine::TurnOrder BattleEngine::determineTurnOrder(Action playerAction, Ac
     playerSpeed = playerSpeed * STAT_STAGE_NUMERATORS[playerStage] / STAT_STAGE_DENOMINATORS[playerStage];
     opponentSpeed = opponentSpeed * STAT_STAGE_NUMERATORS[opponentStage] / STAT_STAGE_DENOMINATORS[opponentStage];
     
-    // Determine order
-    bool playerFirst;
-    if (playerPriority != opponentPriority) {
-        playerFirst = playerPriority > opponentPriority;
-    } else if (playerSpeed != opponentSpeed) {
-        playerFirst = playerSpeed > opponentSpeed;
-    } else {
-        // Speed tie: 50/50
-        playerFirst = randomRange(2) == 0;
-    }
+    if (playerPriority != opponentPriority) return playerPriority > opponentPriority ? 1 : -1;
+    if (playerSpeed != opponentSpeed) return playerSpeed > opponentSpeed ? 1 : -1;
+    return 0;
+}
+
+BattleEngine::TurnOrder BattleEngine::determineTurnOrder(Action playerAction, Action opponentAction) {
+    PKMN_PERF_SCOPE(PerfPhase::TurnOrder);
+    TurnOrder order;
+    
+    // Speed tie: 50/50
+    int cmp = compareTurnOrder(playerAction, opponentAction);
+    bool playerFirst = cmp != 0 ? cmp > 0 : rollSpeedTie();
     
     if (playerFirst) {
         order.first = 0;
@@ -252,15 +323,29 @@ BattleEngine::TurnOrder BattleEngine::determineTurnOrder(Action playerAction, Ac
     return order;
 }
 
+void BattleEngine::setActiveHP(uint8_t side, int hp) {
+    Pokemon& mon = m_state.getActivePokemon(side);
+    const uint8_t slot = m_state.active[side].partyIndex;
+    const uint16_t newHP = static_cast<uint16_t>(std::clamp(hp, 0, static_cast<int>(mon.maxHP)));
+    m_state.hash ^= zobristHP(side, slot, mon.currentHP) ^ zobristHP(side, slot, newHP);
+    mon.currentHP = newHP;
+}
+
 void BattleEngine::executeSwitch(uint8_t side, uint8_t newPartyIndex) {
+    m_state.hash ^= zobristActive(m_state.active[side], side);
+    
     // Clear volatile status
     m_state.active[side].reset();
     m_state.active[side].partyIndex = newPartyIndex;
+    m_state.revealedMask[side] |= static_cast<uint8_t>(1u << newPartyIndex);
+    
+    m_state.hash ^= zobristActive(m_state.active[side], side);
     
     // TODO: Entry hazards (Spikes, Stealth Rock)
 }
 
 void BattleEngine::executeMove(uint8_t attackerSide, uint8_t defenderSide, uint16_t moveId) {
+    PKMN_PERF_SCOPE(PerfPhase::ExecuteMove);
     Pokemon& attacker = m_state.getActivePokemon(attackerSide);
     Pokemon& defender = m_state.getActivePokemon(defenderSide);
     const MoveData& move = getMoveData(moveId);
@@ -268,6 +353,9 @@ void BattleEngine::executeMove(uint8_t attackerSide, uint8_t defenderSide, uint1
     // Deduct PP
     for (int i = 0; i < MAX_MOVES; i++) {
         if (attacker.moves[i] == moveId && attacker.pp[i] > 0) {
+            const uint8_t slot = m_state.active[attackerSide].partyIndex;
+            m_state.hash ^= zobristPP(attackerSide, slot, i, attacker.pp[i]) ^
+                            zobristPP(attackerSide, slot, i, attacker.pp[i] - 1);
             attacker.pp[i]--;
             break;
         }
@@ -280,7 +368,7 @@ void BattleEngine::executeMove(uint8_t attackerSide, uint8_t defenderSide, uint1
         accStage = std::clamp(accStage, 0, 12);
         
         int accuracy = move.accuracy * ACC_STAGE_NUMERATORS[accStage] / ACC_STAGE_DENOMINATORS[accStage];
-        if (randomRange(100) >= accuracy) {
+        if (!rollAccuracy(accuracy)) {
             return;  // Miss!
         }
     }
@@ -288,13 +376,13 @@ void BattleEngine::executeMove(uint8_t attackerSide, uint8_t defenderSide, uint1
     // Calculate and apply damage
     if (move.power > 0) {
         int damage = calculateDamage(attackerSide, defenderSide, moveId);
-        defender.currentHP = std::max(0, static_cast<int>(defender.currentHP) - damage);
+        setActiveHP(defenderSide, defender.currentHP - damage);
         
         // Handle Recoil
         if (move.effect == MoveEffect::RECOIL || move.effect == MoveEffect::DOUBLE_EDGE) {
             int recoil = damage / 4;
             if (recoil == 0 && damage > 0) recoil = 1;
-            attacker.currentHP = std::max(0, static_cast<int>(attacker.currentHP) - recoil);
+            setActiveHP(attackerSide, attacker.currentHP - recoil);
         }
     }
     
@@ -302,6 +390,7 @@ void BattleEngine::executeMove(uint8_t attackerSide, uint8_t defenderSide, uint1
 }
 
 void BattleEngine::applyEndOfTurnEffects() {
+    PKMN_PERF_SCOPE(PerfPhase::EndOfTurn);
     // Weather damage
     if (m_state.weather == Weather::Sandstorm || m_state.weather == Weather::Hail) {
         for (int side = 0; side < 2; side++) {
@@ -320,7 +409,7 @@ void BattleEngine::applyEndOfTurnEffects() {
             if (!immune) {
                 int damage = mon.maxHP / 16;
                 if (damage == 0) damage = 1;
-                mon.currentHP = std::max(0, static_cast<int>(mon.currentHP) - damage);
+                setActiveHP(side, mon.currentHP - damage);
             }
         }
     }
@@ -332,12 +421,12 @@ void BattleEngine::applyEndOfTurnEffects() {
         if (mon.status == Status::Burn || mon.status == Status::Poison) {
             int damage = mon.maxHP / 8;
             if (damage == 0) damage = 1;
-            mon.currentHP = std::max(0, static_cast<int>(mon.currentHP) - damage);
+            setActiveHP(side, mon.currentHP - damage);
         } else if (mon.status == Status::BadPoison) {
             // TODO: Track toxic counter for escalating damage
             int damage = mon.maxHP / 16;
             if (damage == 0) damage = 1;
-            mon.currentHP = std::max(0, static_cast<int>(mon.currentHP) - damage);
+            setActiveHP(side, mon.currentHP - damage);
         }
     }
     
@@ -347,41 +436,57 @@ void BattleEngine::applyEndOfTurnEffects() {
         if (mon.heldItem == ITEM_LEFTOVERS && mon.currentHP > 0) {
             int heal = mon.maxHP / 16;
             if (heal == 0) heal = 1;
-            mon.currentHP = std::min(static_cast<int>(mon.maxHP), static_cast<int>(mon.currentHP) + heal);
+            setActiveHP(side, mon.currentHP + heal);
         }
     }
     
     // Decrement weather turns
     if (m_state.weatherTurns > 0) {
+        m_state.hash ^= zobristField(m_state);
         m_state.weatherTurns--;
         if (m_state.weatherTurns == 0) {
             m_state.weather = Weather::None;
         }
+        m_state.hash ^= zobristField(m_state);
+    }
+}
+
+void BattleEngine::replaceFaintedActives() {
+    // Simplification: the first healthy party member comes in automatically
+    // (the game lets the trainer pick the replacement)
+    for (uint8_t side = 0; side < 2; side++) {
+        if (m_state.getActivePokemon(side).currentHP > 0) continue;
+        for (uint8_t i = 0; i < m_state.teamSizes[side]; i++) {
+            if (m_state.teams[side][i].currentHP > 0) {
+                executeSwitch(side, i);
+                break;
+            }
+        }
+    }
+}
+
+void BattleEngine::executeAction(uint8_t side, Action action, uint8_t slot) {
+    m_forcedMove = slot;
+    if (action.isSwitch()) {
+        executeSwitch(side, action.getSwitchTarget());
+    } else if (action.isMove()) {
+        uint16_t moveId = action.type == ActionType::Struggle ?
+            MOVE_STRUGGLE : m_state.getActivePokemon(side).moves[action.getMoveIndex()];
+        executeMove(side, 1 - side, moveId);
     }
 }
 
 void BattleEngine::executeTurn(Action playerAction, Action opponentAction) {
+    PKMN_PERF_SCOPE(PerfPhase::Turn);
     TurnOrder order = determineTurnOrder(playerAction, opponentAction);
     
     // First action
-    if (order.firstAction.isSwitch()) {
-        executeSwitch(order.first, order.firstAction.getSwitchTarget());
-    } else if (order.firstAction.isMove()) {
-        uint16_t moveId = order.firstAction.type == ActionType::Struggle ?
-            MOVE_STRUGGLE : m_state.getActivePokemon(order.first).moves[order.firstAction.getMoveIndex()];
-        executeMove(order.first, 1 - order.first, moveId);
-    }
+    executeAction(order.first, order.firstAction, 0);
     
     // Check if defender fainted
     if (!m_state.isTerminal() && m_state.getActivePokemon(order.second).currentHP > 0) {
         // Second action
-        if (order.secondAction.isSwitch()) {
-            executeSwitch(order.second, order.secondAction.getSwitchTarget());
-        } else if (order.secondAction.isMove()) {
-            uint16_t moveId = order.secondAction.type == ActionType::Struggle ?
-                MOVE_STRUGGLE : m_state.getActivePokemon(order.second).moves[order.secondAction.getMoveIndex()];
-            executeMove(order.second, 1 - order.second, moveId);
-        }
+        executeAction(order.second, order.secondAction, 1);
     }
     
     // End of turn effects
@@ -389,13 +494,28 @@ void BattleEngine::executeTurn(Action playerAction, Action opponentAction) {
         applyEndOfTurnEffects();
     }
     
+    // Send in replacements for anything that fainted this turn
+    if (!m_state.isTerminal()) {
+        replaceFaintedActives();
+    }
+    
+    m_state.hash ^= zobristTurn(m_state.turnNumber) ^ zobristTurn(m_state.turnNumber + 1);
     m_state.turnNumber++;
+    
+#ifdef PKMN_VERIFY_ZOBRIST
+    if (m_state.hash != zobristHash(m_state)) {
+        std::fprintf(stderr, "Zobrist hash diverged on turn %u\n", m_state.turnNumber);
+        std::abort();
+    }
+#endif
 }
 
 StepResult BattleEngine::step(Action playerAction) {
-    // Get AI action for opponent (battler 1)
-    Action opponentAction = chooseAIAction(*this, 1);
-    
+    // Opponent (battler 1) acts under its policy
+    return stepBoth(playerAction, choosePolicyAction(*this, 1, m_opponentPolicy));
+}
+
+StepResult BattleEngine::stepBoth(Action playerAction, Action opponentAction) {
     executeTurn(playerAction, opponentAction);
     
     StepResult result;
@@ -406,11 +526,136 @@ StepResult BattleEngine::step(Action playerAction) {
     return result;
 }
 
+StepResult BattleEngine::stepWithOutcome(Action playerAction, Action opponentAction, const TurnOutcome& outcome) {
+    m_forced = outcome;
+    m_forcing = true;
+    StepResult result = stepBoth(playerAction, opponentAction);
+    m_forcing = false;
+    return result;
+}
+
+// ============================================================================
+// Chance Outcome Enumeration
+// ============================================================================
+
+int BattleEngine::moveBranches(uint8_t side, Action action, const ChanceModel& model, MoveBranch* out) const {
+    // Switches and status moves (no secondary effects yet) draw nothing that matters
+    out[0] = MoveBranch{MoveOutcome{}, 1.0f, 0};
+    if (!action.isMove()) return 1;
+    uint16_t moveId = action.type == ActionType::Struggle ?
+        MOVE_STRUGGLE : m_state.getActivePokemon(side).moves[action.getMoveIndex()];
+    const MoveData& move = getMoveData(moveId);
+    if (move.power == 0) return 1;
+    
+    // Same accuracy and crit math as executeMove / calculateDamage
+    float hitChance = 1.0f;
+    if (move.accuracy > 0) {
+        int accStage = std::clamp(m_state.active[side].statStages[BattleStat::ACC] -
+                                  m_state.active[1 - side].statStages[BattleStat::EVA] + 6, 0, 12);
+        int accuracy = move.accuracy * ACC_STAGE_NUMERATORS[accStage] / ACC_STAGE_DENOMINATORS[accStage];
+        hitChance = std::clamp(accuracy, 0, 100) / 100.0f;
+    }
+    int critStage = std::min(move.effect == MoveEffect::HIGH_CRITICAL ? 1 : 0, 4);
+    float critChance = model.branchCrits ?
+        static_cast<float>(CRIT_CHANCE_NUMERATORS[critStage]) / CRIT_CHANCE_DENOMINATORS[critStage] : 0.0f;
+    
+    // Recoil depends on the raw damage; otherwise anything past the defender's HP is the same KO
+    const bool recoil = move.effect == MoveEffect::RECOIL || move.effect == MoveEffect::DOUBLE_EDGE;
+    const int defenderHP = m_state.getActivePokemon(1 - side).currentHP;
+    
+    int count = 0;
+    auto add = [&](const MoveOutcome& outcome, float probability, int damage) {
+        if (probability <= 0.0f) return;
+        if (!recoil) damage = std::min(damage, defenderHP);
+        for (int i = 0; i < count; i++) {
+            if (out[i].damage == damage) {
+                out[i].probability += probability;
+                return;
+            }
+        }
+        out[count++] = MoveBranch{outcome, probability, damage};
+    };
+    
+    // A miss deals no damage, so it merges with zero-damage hits
+    add(MoveOutcome{false, false, 100}, 1.0f - hitChance, 0);
+    
+    const int buckets = std::clamp<int>(model.damageBuckets, 1, MAX_DAMAGE_BUCKETS);
+    for (int crit = 0; crit < 2; crit++) {
+        float pCrit = crit ? critChance : 1.0f - critChance;
+        for (int b = 0; b < buckets; b++) {
+            // Rolls [lo, hi) of 85-100, represented by their middle roll
+            int lo = 85 + 16 * b / buckets;
+            int hi = 85 + 16 * (b + 1) / buckets;
+            int roll = (lo + hi - 1) / 2;
+            int damage = calculateDamageWithRolls(side, 1 - side, moveId, crit != 0, roll);
+            add(MoveOutcome{true, crit != 0, static_cast<uint8_t>(roll)},
+                hitChance * pCrit * (hi - lo) / 16.0f, damage);
+        }
+    }
+    return count;
+}
+
+int BattleEngine::enumerateTurnOutcomes(Action playerAction, Action opponentAction, const ChanceModel& model,
+                                        WeightedOutcome* out) const {
+    int cmp = compareTurnOrder(playerAction, opponentAction);
+    int count = 0;
+    
+    for (int tie = 0; tie < (cmp == 0 ? 2 : 1); tie++) {
+        bool playerFirst = cmp != 0 ? cmp > 0 : tie == 0;
+        float pOrder = cmp == 0 ? 0.5f : 1.0f;
+        uint8_t first = playerFirst ? 0 : 1;
+        Action firstAction = playerFirst ? playerAction : opponentAction;
+        Action secondAction = playerFirst ? opponentAction : playerAction;
+        
+        MoveBranch firstBranches[MAX_MOVE_BRANCHES];
+        int numFirst = moveBranches(first, firstAction, model, firstBranches);
+        for (int i = 0; i < numFirst; i++) {
+            TurnOutcome outcome;
+            outcome.playerFirst = playerFirst;
+            outcome.moves[0] = firstBranches[i].outcome;
+            
+            // The second action's odds depend on the state after the first
+            BattleEngine after = *this;
+            after.m_forced = outcome;
+            after.m_forcing = true;
+            after.executeAction(first, firstAction, 0);
+            
+            MoveBranch secondBranches[MAX_MOVE_BRANCHES];
+            int numSecond = 1;
+            secondBranches[0] = MoveBranch{MoveOutcome{}, 1.0f, 0};
+            if (!after.m_state.isTerminal() && after.m_state.getActivePokemon(1 - first).currentHP > 0) {
+                numSecond = after.moveBranches(1 - first, secondAction, model, secondBranches);
+            }
+            for (int j = 0; j < numSecond; j++) {
+                outcome.moves[1] = secondBranches[j].outcome;
+                out[count++] = WeightedOutcome{outcome, pOrder * firstBranches[i].probability *
+                                                        secondBranches[j].probability};
+            }
+        }
+    }
+    return count;
+}
+
 // ============================================================================
 // Vectorized Environment
 // ============================================================================
 
-VecBattleEnv::VecBattleEnv(size_t numEnvs) : m_envs(numEnvs) {}
+// Battles are a few microseconds per turn; small chunks keep long and short
+// battles balanced across workers.
+static constexpr size_t VEC_ENV_GRAIN = 16;
+
+VecBattleEnv::VecBattleEnv(size_t numEnvs, size_t numThreads)
+    : m_envs(numEnvs), m_pool(std::make_unique<ThreadPool>(numThreads)) {}
+
+VecBattleEnv::~VecBattleEnv() = default;
+
+void VecBattleEnv::setNumThreads(size_t numThreads) {
+    m_pool = std::make_unique<ThreadPool>(numThreads);
+}
+
+size_t VecBattleEnv::numThreads() const {
+    return m_pool->size();
+}
 
 void VecBattleEnv::reset(const uint32_t* seeds, size_t count) {
     for (size_t i = 0; i < m_envs.size() && i < count; i++) {
@@ -418,13 +663,79 @@ void VecBattleEnv::reset(const uint32_t* seeds, size_t count) {
     }
 }
 
+void VecBattleEnv::setRngMode(RngMode mode) {
+    for (BattleEngine& env : m_envs) env.setRngMode(mode);
+}
+
+void VecBattleEnv::seedCounterRngs(uint64_t globalSeed, const uint64_t* episodes, size_t count) {
+    for (size_t i = 0; i < m_envs.size() && i < count; i++) {
+        m_envs[i].seedCounterRng(counterRngKey(globalSeed, i, episodes[i]));
+    }
+}
+
 void VecBattleEnv::step(const Action* actions, float* rewards, bool* dones, size_t count) {
     size_t n = std::min(m_envs.size(), count);
-    for (size_t i = 0; i < n; i++) {
-        StepResult result = m_envs[i].step(actions[i]);
-        rewards[i] = result.reward;
-        dones[i] = result.done;
-    }
+    m_pool->parallelFor(n, VEC_ENV_GRAIN, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            PKMN_TRACE_SCOPE(TraceEvent::EnvStep, i, 0);
+            StepResult result = m_envs[i].step(actions[i]);
+            rewards[i] = result.reward;
+            dones[i] = result.done;
+        }
+    });
+}
+
+void VecBattleEnv::setOpponentPolicy(const Policy& policy) {
+    for (BattleEngine& env : m_envs) env.setOpponentPolicy(policy);
+}
+
+void VecBattleEnv::stepBoth(const Action* actions, float* rewards, bool* dones, size_t count) {
+    size_t n = std::min(m_envs.size(), count);
+    m_pool->parallelFor(n, VEC_ENV_GRAIN, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            PKMN_TRACE_SCOPE(TraceEvent::EnvStep, i, 0);
+            StepResult result = m_envs[i].stepBoth(actions[i * 2], actions[i * 2 + 1]);
+            rewards[i] = result.reward;
+            dones[i] = result.done;
+        }
+    });
+}
+
+void VecBattleEnv::observe(float* obs, uint8_t* masks, int8_t* aiScores, size_t count) const {
+    size_t n = std::min(m_envs.size(), count);
+    m_pool->parallelFor(n, VEC_ENV_GRAIN, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            const BattleEngine& env = m_envs[i];
+            encodeObservation(env.getState(), 0, obs + i * OBS_SIZE);
+            encodeActionMask(env, 0, masks + i * NUM_ACTION_TYPES);
+            if (!aiScores) continue;
+            int8_t* scores = aiScores + i * 4;
+            if (env.isTerminal()) {
+                std::fill(scores, scores + 4, 0);
+            } else {
+                BattleEngine scratch = env;
+                chooseAIAction(scratch, 0, scores);
+            }
+        }
+    });
+}
+
+void VecBattleEnv::setTeamsFromIds(const uint16_t* ids, size_t count, int level) {
+    constexpr size_t TEAM = FactoryGenerator::OPPONENT_TEAM_SIZE;
+    size_t n = std::min(m_envs.size(), count);
+    m_pool->parallelFor(n, VEC_ENV_GRAIN, [&](size_t begin, size_t end, size_t) {
+        Pokemon team[TEAM];
+        for (size_t i = begin; i < end; i++) {
+            for (int side = 0; side < 2; side++) {
+                const uint16_t* row = ids + (i * 2 + side) * TEAM;
+                for (size_t k = 0; k < TEAM; k++) {
+                    team[k] = FactoryGenerator::createPokemon(row[k], level);
+                }
+                if (side == 0) m_envs[i].setPlayerTeam(team, TEAM);
+                else m_envs[i].setOpponentTeam(team, TEAM);
+            }
+        }
+    });
 }
 
 void VecBattleEnv::setPlayerTeam(size_t idx, const Pokemon* mons, uint8_t count) {
@@ -439,4 +750,10 @@ void VecBattleEnv::setOpponentTeam(size_t idx, const Pokemon* mons, uint8_t coun
     }
 }
 
+LookaheadResult VecBattleEnv::lookaheadAll(size_t idx, uint32_t samples, uint64_t seed) const {
+    LookaheadConfig config;
+    config.seed = seed;
+    return pkmn::lookaheadAll(m_envs[idx], samples, *m_pool, config);
+}
+
 }  // namespace pkmn
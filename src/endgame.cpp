@@ -0,0 +1,246 @@
+#include "endgame.hpp"
+#include "constants.hpp"
+#include "matrix_game.hpp"
+#include "policy.hpp"
+#include "rng.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace pkmn {
+
+// Value iteration for components of positions that can recur: sweeps stop
+// once no value moves by more than the tolerance
+static constexpr int ENDGAME_MAX_SWEEPS = 256;
+static constexpr float ENDGAME_TOLERANCE = 1e-6f;
+
+// Stage game of an unsolved position: each cell is reward plus the
+// probability-weighted values of successors in the same component
+struct EndgameSolver::Pending {
+    struct Link {
+        uint8_t cell;
+        float probability;
+        Entry* next;
+    };
+    Action rows[MAX_LEGAL_ACTIONS], cols[MAX_LEGAL_ACTIONS];
+    int numRows, numCols;
+    float reward[MAX_LEGAL_ACTIONS * MAX_LEGAL_ACTIONS];
+    std::vector<Link> links;
+};
+
+bool isOneVsOne(const BattleEngine& engine) {
+    const BattleState& state = engine.getState();
+    return state.countRemaining(0) == 1 && state.countRemaining(1) == 1 &&
+           state.getActivePokemon(0).currentHP > 0 && state.getActivePokemon(1).currentHP > 0;
+}
+
+EndgameSolver::EndgameSolver(const EndgameConfig& config) : m_config(config) {}
+
+EndgameSolver::~EndgameSolver() = default;
+
+size_t EndgameSolver::KeyHash::operator()(const Key& key) const {
+    uint64_t h = 0;
+    for (uint64_t word : key) h = splitMix64(h ^ word);
+    return static_cast<size_t>(h);
+}
+
+EndgameSolver::Key EndgameSolver::makeKey(const BattleState& state) {
+    const Pokemon& a = state.getActivePokemon(0);
+    const Pokemon& b = state.getActivePokemon(1);
+    Key key{};
+
+    key[0] = uint64_t(a.currentHP) | uint64_t(b.currentHP) << 16 | uint64_t(state.weather) << 32 |
+             uint64_t(state.weatherTurns) << 40 | uint64_t(a.status) << 48 | uint64_t(b.status) << 56;
+    for (int s = 0; s < BATTLE_STAT_COUNT; s++) {
+        key[1] |= uint64_t(state.active[0].statStages[s] + 6) << (4 * s);
+        key[1] |= uint64_t(state.active[1].statStages[s] + 6) << (28 + 4 * s);
+    }
+    for (int side = 0; side < 2; side++) {
+        const ActiveMon& mon = state.active[side];
+        const SideState& field = state.sides[side];
+        key[2] |= (uint64_t(mon.confusionTurns) | uint64_t(mon.tauntTurns) << 8 | uint64_t(mon.substituteHP) << 16 |
+                   uint64_t(std::min<uint8_t>(mon.protectUses, 15)) << 24 | uint64_t(mon.isConfused) << 28 |
+                   uint64_t(mon.isTaunted) << 29 | uint64_t(mon.isSeeded) << 30 | uint64_t(mon.hasSubstitute) << 31)
+                  << (32 * side);
+        key[3] |= (uint64_t(field.reflectTurns) | uint64_t(field.lightScreenTurns) << 8 |
+                   uint64_t(field.hasReflect) << 16 | uint64_t(field.hasLightScreen) << 17 |
+                   uint64_t(mon.types[0]) << 18 | uint64_t(mon.types[1]) << 23 | uint64_t(mon.typesOverridden) << 28)
+                  << (32 * side);
+    }
+
+    // Everything fixed for the matchup, folded into one word
+    uint64_t identity = 0;
+    for (const Pokemon* mon : {&a, &b}) {
+        identity = splitMix64(identity ^ (uint64_t(mon->species) | uint64_t(mon->heldItem) << 16 |
+                                          uint64_t(mon->ability) << 32 | uint64_t(mon->level) << 40 |
+                                          uint64_t(mon->maxHP) << 48));
+        identity = splitMix64(identity ^ (uint64_t(mon->moves[0]) | uint64_t(mon->moves[1]) << 16 |
+                                          uint64_t(mon->moves[2]) << 32 | uint64_t(mon->moves[3]) << 48));
+        identity = splitMix64(identity ^ (uint64_t(mon->stats[0]) | uint64_t(mon->stats[1]) << 16 |
+                                          uint64_t(mon->stats[2]) << 32 | uint64_t(mon->stats[3]) << 48));
+        identity = splitMix64(identity ^ (uint64_t(mon->stats[4]) | uint64_t(mon->stats[5]) << 16));
+    }
+    key[4] = identity;
+
+    // PP up to the cap: how soon a move runs out (and Struggle starts) changes the value
+    for (int i = 0; i < MAX_MOVES; i++) {
+        key[5] |= uint64_t(std::min<int>(a.pp[i], ENDGAME_PP_CAP)) << (8 * i) |
+                  uint64_t(std::min<int>(b.pp[i], ENDGAME_PP_CAP)) << (32 + 8 * i);
+    }
+    return key;
+}
+
+// Value of one matrix game, taking a pure saddle point exactly when there is one
+static float solveStage(const float* payoff, int rows, int cols, uint32_t iterations,
+                        float* rowStrategy, float* colStrategy) {
+    int bestRow = 0, bestCol = 0;
+    float maximin = -1.0f, minimax = 2.0f;
+    for (int i = 0; i < rows; i++) {
+        float worst = *std::min_element(payoff + i * cols, payoff + (i + 1) * cols);
+        if (worst > maximin) {
+            maximin = worst;
+            bestRow = i;
+        }
+    }
+    for (int j = 0; j < cols; j++) {
+        float best = payoff[j];
+        for (int i = 1; i < rows; i++) best = std::max(best, payoff[i * cols + j]);
+        if (best < minimax) {
+            minimax = best;
+            bestCol = j;
+        }
+    }
+
+    if (maximin >= minimax) {
+        std::fill(rowStrategy, rowStrategy + rows, 0.0f);
+        std::fill(colStrategy, colStrategy + cols, 0.0f);
+        rowStrategy[bestRow] = 1.0f;
+        colStrategy[bestCol] = 1.0f;
+        return payoff[bestRow * cols + bestCol];
+    }
+    return solveMatrixGame(payoff, rows, cols, iterations, rowStrategy, colStrategy);
+}
+
+// Solve a stage game into the entry's value and policies
+static float solveEntryStage(const Action* rows, int numRows, const Action* cols, int numCols, const float* payoff,
+                             uint32_t iterations, EndgameSolution& solution) {
+    float rowStrategy[MAX_LEGAL_ACTIONS] = {}, colStrategy[MAX_LEGAL_ACTIONS] = {};
+    const float value = solveStage(payoff, numRows, numCols, iterations, rowStrategy, colStrategy);
+    solution = EndgameSolution{};
+    solution.value = value;
+    for (int i = 0; i < numRows; i++) solution.playerPolicy[static_cast<uint8_t>(rows[i].type)] = rowStrategy[i];
+    for (int j = 0; j < numCols; j++) solution.opponentPolicy[static_cast<uint8_t>(cols[j].type)] = colStrategy[j];
+    return value;
+}
+
+EndgameSolver::Entry* EndgameSolver::visit(const BattleEngine& engine, size_t depth) {
+    auto [it, inserted] = m_table.try_emplace(makeKey(engine.getState()));
+    Entry& entry = it->second;  // Node-based map: stays valid while children are inserted
+    if (!inserted) return &entry;  // Solved, or unsolved in the component being searched
+    entry.solved = false;
+    entry.index = entry.lowLink = m_nextIndex++;
+    entry.solution.value = 0.5f;
+    m_stack.push_back(&entry);
+
+    // One outcome buffer per recursion depth, reused across positions
+    if (m_scratch.size() <= depth) m_scratch.emplace_back(new WeightedOutcome[MAX_TURN_OUTCOMES]);
+    WeightedOutcome* outcomes = m_scratch[depth].get();
+
+    auto pending = std::make_unique<Pending>();
+    pending->numRows = engine.getLegalActions(0, pending->rows);
+    pending->numCols = engine.getLegalActions(1, pending->cols);
+    const int cells = pending->numRows * pending->numCols;
+    for (int c = 0; c < cells; c++) {
+        Action row = pending->rows[c / pending->numCols], col = pending->cols[c % pending->numCols];
+        int count = engine.enumerateTurnOutcomes(row, col, m_config.chance, outcomes);
+        pending->reward[c] = 0.0f;
+        for (int k = 0; k < count; k++) {
+            BattleEngine next = engine;
+            next.stepWithOutcome(row, col, outcomes[k].outcome);
+            if (next.isTerminal()) {
+                pending->reward[c] += outcomes[k].probability * outcomeValue(next);
+                continue;
+            }
+            Entry* child = visit(next, depth + 1);
+            if (child->solved) {
+                pending->reward[c] += outcomes[k].probability * child->solution.value;
+            } else {
+                // Unsolved means still on the stack, so in this position's component or an ancestor's
+                entry.lowLink = std::min(entry.lowLink, child->lowLink);
+                pending->links.push_back({static_cast<uint8_t>(c), outcomes[k].probability, child});
+            }
+        }
+    }
+    entry.pending = std::move(pending);
+
+    if (entry.lowLink == entry.index) {
+        size_t begin = m_stack.size();
+        while (m_stack[--begin] != &entry) {}
+        solveComponent(begin);
+    }
+    return &entry;
+}
+
+void EndgameSolver::solveComponent(size_t begin) {
+    // Gauss-Seidel value iteration over the component, from 0.5 everywhere;
+    // a single pass when nothing links back into it
+    bool recurrent = false;
+    for (size_t m = begin; m < m_stack.size(); m++) recurrent |= !m_stack[m]->pending->links.empty();
+
+    float payoff[MAX_LEGAL_ACTIONS * MAX_LEGAL_ACTIONS];
+    const int sweeps = recurrent ? ENDGAME_MAX_SWEEPS : 1;
+    for (int sweep = 0; sweep < sweeps; sweep++) {
+        float change = 0.0f;
+        for (size_t m = begin; m < m_stack.size(); m++) {
+            Entry& entry = *m_stack[m];
+            const Pending& pending = *entry.pending;
+            std::copy(pending.reward, pending.reward + pending.numRows * pending.numCols, payoff);
+            for (const Pending::Link& link : pending.links) {
+                payoff[link.cell] += link.probability * link.next->solution.value;
+            }
+            const float previous = entry.solution.value;
+            solveEntryStage(pending.rows, pending.numRows, pending.cols, pending.numCols, payoff,
+                            m_config.solverIterations, entry.solution);
+            change = std::max(change, std::abs(entry.solution.value - previous));
+        }
+        if (change < ENDGAME_TOLERANCE) break;
+    }
+
+    for (size_t m = begin; m < m_stack.size(); m++) {
+        m_stack[m]->solved = true;
+        m_stack[m]->pending.reset();
+    }
+    m_stack.resize(begin);
+}
+
+float EndgameSolver::solveLocked(const BattleEngine& engine) {
+    m_nextIndex = 0;  // Everything searched before is solved
+    return visit(engine, 0)->solution.value;
+}
+
+bool EndgameSolver::solve(const BattleEngine& engine, EndgameSolution& out) {
+    if (!isOneVsOne(engine)) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    solveLocked(engine);
+    out = m_table.find(makeKey(engine.getState()))->second.solution;
+    return true;
+}
+
+float EndgameSolver::value(const BattleEngine& engine) {
+    if (!isOneVsOne(engine)) return -1.0f;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return solveLocked(engine);
+}
+
+size_t EndgameSolver::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_table.size();
+}
+
+void EndgameSolver::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_table.clear();
+}
+
+}  // namespace pkmn
@@ -0,0 +1,246 @@
+#include "evaluator.hpp"
+#include "factory.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace pkmn {
+
+// Seed streams, so opponent generation and battle RNG never share seeds
+enum : uint64_t { STREAM_OPPONENT = 0, STREAM_BATTLE = 1 };
+
+// A few battles per chunk: each one is tens of microseconds
+static constexpr size_t EVALUATOR_GRAIN = 4;
+
+// Playouts start mid-battle and skip team setup, so batch more of them
+static constexpr size_t PLAYOUT_GRAIN = 16;
+
+WinRateEstimate makeWinRateEstimate(uint32_t wins, uint32_t samples) {
+    WinRateEstimate est{};
+    est.wins = wins;
+    est.samples = samples;
+    if (samples == 0) {
+        est.ciHigh = 1.0f;
+        return est;
+    }
+
+    const double z = 1.96;
+    double n = samples;
+    double p = wins / n;
+    double denom = 1.0 + z * z / n;
+    double center = (p + z * z / (2.0 * n)) / denom;
+    double half = z * std::sqrt(p * (1.0 - p) / n + z * z / (4.0 * n * n)) / denom;
+
+    est.winRate = static_cast<float>(p);
+    est.ciLow = static_cast<float>(std::max(0.0, center - half));
+    est.ciHigh = static_cast<float>(std::min(1.0, center + half));
+    return est;
+}
+
+const std::array<RentalCombo, NUM_RENTAL_COMBOS>& getRentalCombos() {
+    static const auto combos = [] {
+        std::array<RentalCombo, NUM_RENTAL_COMBOS> out{};
+        int n = 0;
+        for (uint8_t a = 0; a < 6; a++)
+            for (uint8_t b = a + 1; b < 6; b++)
+                for (uint8_t c = b + 1; c < 6; c++)
+                    out[n++] = {a, b, c};
+        return out;
+    }();
+    return combos;
+}
+
+std::array<WinRateEstimate, NUM_RENTAL_COMBOS> evaluateRentalCombos(
+    const uint16_t pool[6], int challengeNum, bool isOpenLevel, uint32_t samples,
+    const EvaluatorConfig& config) {
+    const int level = isOpenLevel ? 100 : 50;
+    const auto& combos = getRentalCombos();
+
+    Pokemon poolMons[6];
+    SpeciesSet poolSpecies;
+    for (int i = 0; i < 6; i++) {
+        poolMons[i] = FactoryGenerator::createPokemon(pool[i], level);
+        poolSpecies.set(poolMons[i].species);
+    }
+
+    // Per-worker tallies, reduced after the loop
+    size_t numWorkers = ThreadPool::resolveThreadCount(config.numThreads);
+    std::vector<std::array<uint32_t, NUM_RENTAL_COMBOS>> wins(numWorkers);
+
+    parallelFor(samples, config.numThreads, EVALUATOR_GRAIN, [&](size_t begin, size_t end, size_t worker) {
+        auto& tally = wins[worker];
+        BattleEngine engine;
+        for (size_t s = begin; s < end; s++) {
+            // Common random numbers: one opponent team and battle seed per sample
+            uint32_t oppSeed = deriveSeed(config.seed, STREAM_OPPONENT, s);
+            FactoryGenerator::OpponentTeam oppIds{};
+            int oppCount = FactoryGenerator::generateOpponentTeam(oppSeed, challengeNum, 1, isOpenLevel,
+                                                                  poolSpecies, oppIds);
+            Pokemon opponents[FactoryGenerator::OPPONENT_TEAM_SIZE];
+            for (int k = 0; k < oppCount; k++) {
+                opponents[k] = FactoryGenerator::createPokemon(oppIds[k], level);
+            }
+            uint32_t battleSeed = deriveSeed(config.seed, STREAM_BATTLE, s);
+
+            for (int c = 0; c < NUM_RENTAL_COMBOS; c++) {
+                Pokemon team[3] = {poolMons[combos[c][0]], poolMons[combos[c][1]], poolMons[combos[c][2]]};
+                engine.reset(battleSeed);
+                engine.setPlayerTeam(team, 3);
+                engine.setOpponentTeam(opponents, static_cast<uint8_t>(oppCount));
+                if (playOut(engine, config.playerPolicy, config.maxTurns) == 0) tally[c]++;
+            }
+        }
+    });
+
+    std::array<WinRateEstimate, NUM_RENTAL_COMBOS> out{};
+    for (int c = 0; c < NUM_RENTAL_COMBOS; c++) {
+        uint32_t total = 0;
+        for (const auto& tally : wins) total += tally[c];
+        out[c] = makeWinRateEstimate(total, samples);
+    }
+    return out;
+}
+
+std::array<SwapEstimate, NUM_SWAP_OPTIONS> evaluateSwaps(
+    const uint16_t team[3], const uint16_t defeated[3], int challengeNum, int battleNum,
+    bool isOpenLevel, uint32_t samples, const EvaluatorConfig& config) {
+    if (battleNum < 0 || battleNum >= BATTLES_PER_CHALLENGE)
+        throw std::runtime_error("battleNum must be in [0, BATTLES_PER_CHALLENGE)");
+    const int level = isOpenLevel ? 100 : 50;
+    const int remaining = BATTLES_PER_CHALLENGE - 1 - battleNum;
+
+    Pokemon teamMons[3], defeatedMons[3];
+    SpeciesSet candidates;
+    for (int i = 0; i < 3; i++) {
+        teamMons[i] = FactoryGenerator::createPokemon(team[i], level);
+        defeatedMons[i] = FactoryGenerator::createPokemon(defeated[i], level);
+        candidates.set(teamMons[i].species);
+        candidates.set(defeatedMons[i].species);
+    }
+
+    // Team for each option, laid out like the SWAP action space
+    Pokemon options[NUM_SWAP_OPTIONS][3];
+    for (int o = 0; o < NUM_SWAP_OPTIONS; o++) {
+        for (int i = 0; i < 3; i++) options[o][i] = teamMons[i];
+        if (o > 0) options[o][(o - 1) / 3] = defeatedMons[(o - 1) % 3];
+    }
+
+    struct Tally {
+        uint32_t survived[NUM_SWAP_OPTIONS];
+        uint64_t battlesWon[NUM_SWAP_OPTIONS];
+    };
+    size_t numWorkers = ThreadPool::resolveThreadCount(config.numThreads);
+    std::vector<Tally> tallies(numWorkers, Tally{});
+
+    parallelFor(samples, config.numThreads, 1, [&](size_t begin, size_t end, size_t worker) {
+        Tally& tally = tallies[worker];
+        BattleEngine engine;
+        Pokemon opponents[BATTLES_PER_CHALLENGE][FactoryGenerator::OPPONENT_TEAM_SIZE];
+        int oppCounts[BATTLES_PER_CHALLENGE];
+        uint32_t battleSeeds[BATTLES_PER_CHALLENGE];
+
+        for (size_t s = begin; s < end; s++) {
+            // Common random numbers: the rest of the challenge is drawn once per sample
+            for (int b = 0; b < remaining; b++) {
+                uint64_t index = s * BATTLES_PER_CHALLENGE + b;
+                uint32_t oppSeed = deriveSeed(config.seed, STREAM_OPPONENT, index);
+                FactoryGenerator::OpponentTeam oppIds{};
+                oppCounts[b] = FactoryGenerator::generateOpponentTeam(oppSeed, challengeNum, battleNum + 1 + b,
+                                                                      isOpenLevel, candidates, oppIds);
+                for (int k = 0; k < oppCounts[b]; k++) {
+                    opponents[b][k] = FactoryGenerator::createPokemon(oppIds[k], level);
+                }
+                battleSeeds[b] = deriveSeed(config.seed, STREAM_BATTLE, index);
+            }
+
+            for (int o = 0; o < NUM_SWAP_OPTIONS; o++) {
+                // HP and PP are restored between battles, so each starts fresh
+                int won = 0;
+                while (won < remaining) {
+                    engine.reset(battleSeeds[won]);
+                    engine.setPlayerTeam(options[o], 3);
+                    engine.setOpponentTeam(opponents[won], static_cast<uint8_t>(oppCounts[won]));
+                    if (playOut(engine, config.playerPolicy, config.maxTurns) != 0) break;
+                    won++;
+                }
+                tally.battlesWon[o] += won;
+                if (won == remaining) tally.survived[o]++;
+            }
+        }
+    });
+
+    std::array<SwapEstimate, NUM_SWAP_OPTIONS> out{};
+    for (int o = 0; o < NUM_SWAP_OPTIONS; o++) {
+        uint32_t survived = 0;
+        uint64_t battlesWon = 0;
+        for (const Tally& tally : tallies) {
+            survived += tally.survived[o];
+            battlesWon += tally.battlesWon[o];
+        }
+        out[o].survival = makeWinRateEstimate(survived, samples);
+        out[o].meanBattlesWon = samples > 0 ? static_cast<float>(battlesWon) / samples : 0.0f;
+    }
+    return out;
+}
+
+namespace {
+
+// One cache line per worker: every playout writes its tally
+struct alignas(64) PlayoutTally {
+    uint32_t wins = 0;
+    uint32_t capped = 0;
+    uint64_t turns = 0;
+    int64_t playerHP = 0;
+    int64_t opponentHP = 0;
+};
+
+}  // namespace
+
+PlayoutStats playouts(const BattleEngine& engine, uint32_t n, PolicyKind policy, uint16_t maxTurns,
+                      uint64_t seed, size_t numThreads) {
+    PlayoutStats out{};
+    out.win = makeWinRateEstimate(0, n);
+    if (n == 0) return out;
+
+    const BattleState& root = engine.getState();
+    const uint16_t startTurn = engine.getTurnCount();
+    const uint16_t cap = static_cast<uint16_t>(std::min<uint32_t>(UINT16_MAX, uint32_t(startTurn) + maxTurns));
+
+    size_t numWorkers = ThreadPool::resolveThreadCount(numThreads);
+    std::vector<PlayoutTally> tallies(numWorkers);
+
+    parallelFor(n, numThreads, PLAYOUT_GRAIN, [&](size_t begin, size_t end, size_t worker) {
+        PlayoutTally& tally = tallies[worker];
+        BattleEngine copy;
+        for (size_t i = begin; i < end; i++) {
+            copy = engine;
+            copy.setRngState(deriveSeed(seed, 0, i));
+            int winner = playOut(copy, policy, cap);
+            if (winner == 0) tally.wins++;
+            else if (winner < 0) tally.capped++;
+            tally.turns += copy.getTurnCount() - startTurn;
+            tally.playerHP += copy.getState().teamHP(0);
+            tally.opponentHP += copy.getState().teamHP(1);
+        }
+    });
+
+    PlayoutTally total;
+    for (const PlayoutTally& tally : tallies) {
+        total.wins += tally.wins;
+        total.capped += tally.capped;
+        total.turns += tally.turns;
+        total.playerHP += tally.playerHP;
+        total.opponentHP += tally.opponentHP;
+    }
+    out.win = makeWinRateEstimate(total.wins, n);
+    out.capped = total.capped;
+    out.meanTurns = static_cast<float>(double(total.turns) / n);
+    out.meanPlayerHP = static_cast<float>(double(total.playerHP) / (double(n) * std::max(root.teamMaxHP(0), 1)));
+    out.meanOpponentHP = static_cast<float>(double(total.opponentHP) / (double(n) * std::max(root.teamMaxHP(1), 1)));
+    return out;
+}
+
+}  // namespace pkmn
@@ -0,0 +1,250 @@
+#include "expectiminimax.hpp"
+#include "policy.hpp"
+#include "transposition.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace pkmn {
+
+float hpFractionValue(const BattleEngine& engine) {
+    const BattleState& state = engine.getState();
+    float fraction[2];
+    for (uint8_t side = 0; side < 2; side++) {
+        int maxHP = state.teamMaxHP(side);
+        fraction[side] = maxHP > 0 ? static_cast<float>(state.teamHP(side)) / maxHP : 0.0f;
+    }
+    return 0.5f + 0.5f * (fraction[0] - fraction[1]);
+}
+
+namespace {
+
+// Values are the player's result in [0, 1]: the bounds Star1 prunes against
+constexpr float VALUE_MIN = 0.0f;
+constexpr float VALUE_MAX = 1.0f;
+
+// Check the clock every this many nodes
+constexpr uint64_t TIME_CHECK_INTERVAL = 64;
+
+struct Searcher {
+    const ExpectiminimaxConfig& config;
+    bool timed;
+    std::chrono::steady_clock::time_point deadline;
+    bool aborted = false;
+    bool horizon = false;  // The current max node's subtree stopped at the depth limit somewhere
+    uint64_t nodes = 0;
+
+    // Counts a node and checks the clock every TIME_CHECK_INTERVAL nodes
+    void visit() {
+        nodes++;
+        if (timed && !aborted && nodes % TIME_CHECK_INTERVAL == 0) {
+            aborted = std::chrono::steady_clock::now() >= deadline;
+        }
+    }
+
+    float leaf(const BattleEngine& engine) {
+        horizon = true;
+        float v = config.evaluator ? config.evaluator(engine) : hpFractionValue(engine);
+        return std::clamp(v, VALUE_MIN, VALUE_MAX);
+    }
+
+    float maxNode(const BattleEngine& engine, int depth, float alpha, float beta);
+    float minNode(const BattleEngine& engine, Action playerAction, int depth, float alpha, float beta);
+    float chanceNode(const BattleEngine& engine, Action playerAction, Action opponentAction, int depth,
+                     float alpha, float beta);
+};
+
+float Searcher::maxNode(const BattleEngine& engine, int depth, float alpha, float beta) {
+    if (engine.isTerminal()) return outcomeValue(engine);
+    if (depth == 0) return leaf(engine);
+
+    Action legal[MAX_LEGAL_ACTIONS];
+    int count = engine.getLegalActions(0, legal);
+
+    TTEntry entry;
+    const bool found = config.table && config.table->probe(engine.getHash(), entry);
+    if (found) {
+        if (entry.depth >= depth) {
+            const bool solved = entry.bound == Bound::Exact && entry.depth == TT_DEPTH_SOLVED;
+            bool hit = entry.bound == Bound::Exact;
+            hit |= config.prune && entry.bound == Bound::Lower && entry.value >= beta;
+            hit |= config.prune && entry.bound == Bound::Upper && entry.value <= alpha;
+            if (hit) {
+                horizon |= !solved;
+                return entry.value;
+            }
+        }
+        // Stored best action first
+        for (int i = 1; i < count; i++) {
+            if (static_cast<uint8_t>(legal[i].type) == entry.bestAction) {
+                std::rotate(legal, legal + i, legal + i + 1);
+                break;
+            }
+        }
+    }
+
+    const bool outerHorizon = horizon;
+    horizon = false;
+    float best = VALUE_MIN;
+    int bestIndex = 0;
+    for (int i = 0; i < count && !aborted; i++) {
+        float v = minNode(engine, legal[i], depth, config.prune ? std::max(alpha, best) : VALUE_MIN, beta);
+        if (v > best || i == 0) {
+            best = v;
+            bestIndex = i;
+        }
+        if (config.prune && best >= beta) break;
+    }
+
+    if (config.table && !aborted) {
+        TTEntry result;
+        result.value = best;
+        result.bestAction = static_cast<uint8_t>(legal[bestIndex].type);
+        result.bound = !config.prune ? Bound::Exact : best <= alpha ? Bound::Upper
+                                                    : best >= beta  ? Bound::Lower : Bound::Exact;
+        // Exact with every line played out is the position's true value
+        const bool solved = result.bound == Bound::Exact && !horizon;
+        result.depth = solved ? TT_DEPTH_SOLVED : static_cast<uint8_t>(std::min(depth, TT_DEPTH_SOLVED - 1));
+        config.table->store(engine.getHash(), result);
+    }
+    horizon |= outerHorizon;
+    return best;
+}
+
+float Searcher::minNode(const BattleEngine& engine, Action playerAction, int depth, float alpha, float beta) {
+    Action legal[MAX_LEGAL_ACTIONS];
+    int count = engine.getLegalActions(1, legal);
+    float best = VALUE_MAX;
+    for (int i = 0; i < count && !aborted; i++) {
+        float v = chanceNode(engine, playerAction, legal[i], depth, alpha,
+                             config.prune ? std::min(beta, best) : VALUE_MAX);
+        best = std::min(best, v);
+        if (config.prune && best <= alpha) break;
+    }
+    return best;
+}
+
+float Searcher::chanceNode(const BattleEngine& engine, Action playerAction, Action opponentAction, int depth,
+                           float alpha, float beta) {
+    WeightedOutcome outcomes[MAX_TURN_OUTCOMES];
+    int count = engine.enumerateTurnOutcomes(playerAction, opponentAction, config.chance, outcomes);
+
+    // Every successor costs a turn simulation, so they are the unit of work
+    auto child = [&](int i) {
+        visit();
+        BattleEngine next = engine;
+        next.stepWithOutcome(playerAction, opponentAction, outcomes[i].outcome);
+        return next;
+    };
+
+    if (!config.prune) {
+        float sum = 0.0f;
+        for (int i = 0; i < count && !aborted; i++) {
+            sum += outcomes[i].probability * maxNode(child(i), depth - 1, VALUE_MIN, VALUE_MAX);
+        }
+        return sum;
+    }
+
+    // Bounds on each successor; Star1 turns them into bounds on this node
+    float lower[MAX_TURN_OUTCOMES], upper[MAX_TURN_OUTCOMES];
+    float sumLo = 0.0f, sumUp = 0.0f;
+    for (int i = 0; i < count; i++) {
+        lower[i] = VALUE_MIN;
+        upper[i] = VALUE_MAX;
+        sumLo += outcomes[i].probability * VALUE_MIN;
+        sumUp += outcomes[i].probability * VALUE_MAX;
+    }
+
+    // Star2 probe: terminal and leaf successors are exact, and one action of
+    // a max successor is a lower bound on it
+    if (config.star2) {
+        for (int i = 0; i < count && !aborted; i++) {
+            const float p = outcomes[i].probability;
+            BattleEngine next = child(i);
+            float lo, up;
+            if (next.isTerminal() || depth - 1 == 0) {
+                lo = up = next.isTerminal() ? outcomeValue(next) : leaf(next);
+            } else {
+                Action legal[MAX_LEGAL_ACTIONS];
+                next.getLegalActions(0, legal);
+                float probeBeta = std::min(VALUE_MAX, (beta - (sumLo - p * lower[i])) / p);
+                lo = minNode(next, legal[0], depth - 1, VALUE_MIN, probeBeta);
+                up = upper[i];
+            }
+            sumLo += p * (lo - lower[i]);
+            sumUp += p * (up - upper[i]);
+            lower[i] = lo;
+            upper[i] = up;
+            if (sumLo >= beta) return sumLo;
+        }
+        if (sumUp <= alpha) return sumUp;
+    }
+
+    // Star1: search each successor in the window that could still change the outcome
+    for (int i = 0; i < count && !aborted; i++) {
+        if (lower[i] == upper[i]) continue;
+        const float p = outcomes[i].probability;
+        sumLo -= p * lower[i];
+        sumUp -= p * upper[i];
+        float childAlpha = std::max(lower[i], (alpha - sumUp) / p);
+        float childBeta = std::min(upper[i], (beta - sumLo) / p);
+
+        float v = maxNode(child(i), depth - 1, childAlpha, childBeta);
+        // Fail-soft: outside the window v only bounds the successor
+        float lo = v, up = v;
+        if (v <= childAlpha) {
+            lo = lower[i];
+            up = std::max(v, lower[i]);
+        } else if (v >= childBeta) {
+            up = upper[i];
+        }
+        sumLo += p * lo;
+        sumUp += p * up;
+        if (sumLo >= beta) return sumLo;
+        if (sumUp <= alpha) return sumUp;
+    }
+    return sumLo;
+}
+
+}  // namespace
+
+ExpectiminimaxResult searchExpectiminimax(const BattleEngine& root, const ExpectiminimaxConfig& config) {
+    auto start = std::chrono::steady_clock::now();
+    Searcher searcher{config, config.timeBudgetMs > 0.0,
+                      start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                          std::chrono::duration<double, std::milli>(config.timeBudgetMs))};
+
+    ExpectiminimaxResult result{};
+    Action order[MAX_LEGAL_ACTIONS];
+    int count = root.getLegalActions(0, order);
+    result.bestAction = order[0];
+    result.value = root.isTerminal() ? outcomeValue(root) : searcher.leaf(root);
+
+    for (int depth = 1; depth <= config.maxDepth && !root.isTerminal(); depth++) {
+        int bestIndex = 0;
+        float bestValue = -1.0f;
+        for (int i = 0; i < count; i++) {
+            float alpha = config.prune ? std::max(bestValue, VALUE_MIN) : VALUE_MIN;
+            float v = searcher.minNode(root, order[i], depth, alpha, VALUE_MAX);
+            if (searcher.aborted) break;
+            if (v > bestValue) {
+                bestValue = v;
+                bestIndex = i;
+            }
+        }
+        if (searcher.aborted) break;
+
+        result.bestAction = order[bestIndex];
+        result.value = bestValue;
+        result.depthReached = static_cast<uint8_t>(depth);
+
+        // Search the best action first next iteration for tighter windows
+        std::rotate(order, order + bestIndex, order + bestIndex + 1);
+        if (bestValue >= VALUE_MAX) break;  // Forced win, nothing deeper can beat it
+    }
+
+    result.nodes = searcher.nodes;
+    result.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+}  // namespace pkmn
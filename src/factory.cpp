@@ -1,6 +1,8 @@
 #include "factory.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
 #include <algorithm>
-#include <set>
+#include <array>
 
 namespace pkmn {
 
@@ -36,7 +38,7 @@ static const uint8_t CHALLENGE_IVS[] = {3, 6, 9, 12, 15, 21, 31, 31};
 
 // Simple LCG for internal use
 static uint32_t nextRandom(uint32_t& seed) {
-    seed = seed * 1103515245 + 12345;
+    seed = seed * FACTORY_RNG_MULT + FACTORY_RNG_INC;
     return (seed / 65536) % 32768;
 }
 
@@ -51,64 +53,128 @@ void FactoryGenerator::getChallengeRanges(int challengeNum, bool isOpenLevel, ui
     }
 }
 
-std::vector<uint16_t> FactoryGenerator::generateRentalPool(uint32_t& rngSeed, int challengeNum, bool isOpenLevel) {
-    uint16_t start, end;
-    getChallengeRanges(challengeNum, isOpenLevel, start, end);
-    
-    std::vector<uint16_t> pool;
-    std::set<uint16_t> usedSpecies;
-    
-    // We need 6 valid mons
-    int attempts = 0;
-    while (pool.size() < 6 && attempts < 1000) {
-        attempts++;
-        uint16_t range = end - start + 1;
-        uint16_t id = start + (nextRandom(rngSeed) % range);
-        
-        // Check uniqueness by ID (allow same species? Gen 3 prevents same species in rental?)
-        // Let's enforce unique species for rentals to be safe
-        const FrontierMon& mon = getFrontierMon(id);
-        if (usedSpecies.count(mon.species)) continue;
-        
-        pool.push_back(id);
-        usedSpecies.insert(mon.species);
+// ============================================================================
+// Eligible Lists
+//
+// Per-(challenge, level mode) list of candidate mons, each entry packed as
+// (species << 16) | frontierMonId so sampling never has to touch FRONTIER_MONS.
+// ============================================================================
+
+struct EligibleList {
+    uint16_t count;
+    uint32_t entries[NUM_FRONTIER_MONS];
+};
+
+static const EligibleList& getEligibleList(int challengeNum, bool isOpenLevel) {
+    static const auto lists = [] {
+        std::array<std::array<EligibleList, 8>, 2> out{};
+        for (int level = 0; level < 2; level++) {
+            for (int chal = 0; chal < 8; chal++) {
+                uint16_t start, end;
+                FactoryGenerator::getChallengeRanges(chal, level == 1, start, end);
+                EligibleList& list = out[level][chal];
+                list.count = 0;
+                for (uint16_t id = start; id <= end; id++) {
+                    list.entries[list.count++] = (static_cast<uint32_t>(getFrontierMon(id).species) << 16) | id;
+                }
+            }
+        }
+        return out;
+    }();
+    return lists[isOpenLevel ? 1 : 0][std::clamp(challengeNum, 0, 7)];
+}
+
+// Partial Fisher-Yates over the eligible list: every draw removes a candidate,
+// so the loop ends after at most list.count iterations.
+static int sampleUniqueSpecies(uint32_t& rngSeed, const EligibleList& list, SpeciesSet& used,
+                               uint16_t* out, int want) {
+    uint32_t scratch[NUM_FRONTIER_MONS];
+    std::copy(list.entries, list.entries + list.count, scratch);
+
+    uint32_t remaining = list.count;
+    int picked = 0;
+    while (picked < want && remaining > 0) {
+        uint32_t slot = nextRandom(rngSeed) % remaining;
+        uint32_t entry = scratch[slot];
+        scratch[slot] = scratch[--remaining];
+
+        uint16_t species = static_cast<uint16_t>(entry >> 16);
+        if (used.test(species)) continue;
+
+        used.set(species);
+        out[picked++] = static_cast<uint16_t>(entry & 0xFFFF);
     }
-    
-    return pool;
+    return picked;
+}
+
+int FactoryGenerator::generateRentalPool(uint32_t& rngSeed, int challengeNum, bool isOpenLevel, RentalPool& out) {
+    // Unique species across the whole rental pool
+    SpeciesSet used;
+    return sampleUniqueSpecies(rngSeed, getEligibleList(challengeNum, isOpenLevel), used,
+                               out.data(), RENTAL_POOL_SIZE);
+}
+
+int FactoryGenerator::generateOpponentTeam(uint32_t& rngSeed, int challengeNum, int /*battleNum*/, bool isOpenLevel,
+                                           const SpeciesSet& excludedSpecies, OpponentTeam& out) {
+    SpeciesSet used = excludedSpecies;
+    return sampleUniqueSpecies(rngSeed, getEligibleList(challengeNum, isOpenLevel), used,
+                               out.data(), OPPONENT_TEAM_SIZE);
 }
 
-std::vector<uint16_t> FactoryGenerator::generateOpponentTeam(uint32_t& rngSeed, int challengeNum, int /*battleNum*/, bool isOpenLevel,
+std::vector<uint16_t> FactoryGenerator::generateRentalPool(uint32_t& rngSeed, int challengeNum, bool isOpenLevel) {
+    RentalPool pool;
+    int count = generateRentalPool(rngSeed, challengeNum, isOpenLevel, pool);
+    return std::vector<uint16_t>(pool.begin(), pool.begin() + count);
+}
+
+std::vector<uint16_t> FactoryGenerator::generateOpponentTeam(uint32_t& rngSeed, int challengeNum, int battleNum, bool isOpenLevel,
                                                   const std::vector<uint16_t>& playerExcludes) {
-    uint16_t start, end;
-    getChallengeRanges(challengeNum, isOpenLevel, start, end);
-    
-    std::vector<uint16_t> team;
-    std::set<uint16_t> usedSpecies;
-    
-    // Add excludes to used set
+    // Player's species can't show up on the opposing team
+    SpeciesSet excluded;
     for (uint16_t id : playerExcludes) {
-        usedSpecies.insert(getFrontierMon(id).species);
+        excluded.set(getFrontierMon(id).species);
     }
-    
-    int attempts = 0;
-    while (team.size() < 3 && attempts < 1000) {
-        attempts++;
-        uint16_t range = end - start + 1;
-        uint16_t id = start + (nextRandom(rngSeed) % range);
-        
-        const FrontierMon& mon = getFrontierMon(id);
-        if (usedSpecies.count(mon.species)) continue;
-        
-        // Also check if id is clearly duplicate in team
-        bool idExists = false;
-        for (uint16_t existing : team) if (existing == id) idExists = true;
-        if (idExists) continue;
-
-        team.push_back(id);
-        usedSpecies.insert(mon.species);
-    }
-    
-    return team;
+
+    OpponentTeam team;
+    int count = generateOpponentTeam(rngSeed, challengeNum, battleNum, isOpenLevel, excluded, team);
+    return std::vector<uint16_t>(team.begin(), team.begin() + count);
+}
+
+// Teams are a few hundred nanoseconds each; keep chunks big enough to amortize
+// the atomic cursor.
+static constexpr size_t GENERATION_GRAIN = 256;
+
+void FactoryGenerator::generateRentalPools(const uint32_t* seeds, size_t count, int challengeNum, bool isOpenLevel,
+                                           uint16_t* out, size_t numThreads) {
+    parallelFor(count, numThreads, GENERATION_GRAIN, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            uint32_t seed = seeds[i];
+            RentalPool pool{};
+            generateRentalPool(seed, challengeNum, isOpenLevel, pool);
+            std::copy(pool.begin(), pool.end(), out + i * RENTAL_POOL_SIZE);
+        }
+    });
+}
+
+void FactoryGenerator::generateOpponentTeams(const uint32_t* seeds, size_t count, int challengeNum, int battleNum,
+                                             bool isOpenLevel, uint16_t* out,
+                                             const uint16_t* excludeIds, size_t excludesPerSeed,
+                                             size_t numThreads) {
+    parallelFor(count, numThreads, GENERATION_GRAIN, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            SpeciesSet excluded;
+            if (excludeIds) {
+                for (size_t k = 0; k < excludesPerSeed; k++) {
+                    excluded.set(getFrontierMon(excludeIds[i * excludesPerSeed + k]).species);
+                }
+            }
+
+            uint32_t seed = seeds[i];
+            OpponentTeam team{};
+            generateOpponentTeam(seed, challengeNum, battleNum, isOpenLevel, excluded, team);
+            std::copy(team.begin(), team.end(), out + i * OPPONENT_TEAM_SIZE);
+        }
+    });
 }
 
 Pokemon FactoryGenerator::createPokemon(uint16_t frontierMonId, int level, uint8_t fixedIV) {
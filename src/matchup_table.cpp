@@ -0,0 +1,209 @@
+#include "matchup_table.hpp"
+#include "ai.hpp"
+#include "battle_engine.hpp"
+#include "factory.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pkmn {
+
+static constexpr char MATCHUP_MAGIC[4] = {'P', 'B', 'M', 'T'};
+
+// ============================================================================
+// Mapping
+// ============================================================================
+
+MatchupTable::MatchupTable(const std::string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open matchup table: " + path);
+    m_fileHandle = file;
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    m_mappedSize = static_cast<size_t>(size.QuadPart);
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        throw std::runtime_error("Cannot map matchup table: " + path);
+    }
+    m_mapHandle = mapping;
+    m_mapping = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open matchup table: " + path);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat matchup table: " + path);
+    }
+    m_mappedSize = static_cast<size_t>(st.st_size);
+
+    void* addr = mmap(nullptr, m_mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // The mapping keeps the file alive
+    m_mapping = (addr == MAP_FAILED) ? nullptr : addr;
+#endif
+
+    if (!m_mapping) {
+        close();
+        throw std::runtime_error("Cannot map matchup table: " + path);
+    }
+
+    // Validate before exposing anything
+    const auto* header = static_cast<const MatchupTableHeader*>(m_mapping);
+    if (m_mappedSize < sizeof(MatchupTableHeader) || std::memcmp(header->magic, MATCHUP_MAGIC, 4) != 0) {
+        close();
+        throw std::runtime_error("Not a matchup table: " + path);
+    }
+    if (header->version != MATCHUP_TABLE_VERSION) {
+        close();
+        throw std::runtime_error("Unsupported matchup table version in " + path);
+    }
+    size_t entries = static_cast<size_t>(header->numLevels) * header->numMons * header->numMons;
+    if (header->numLevels != MATCHUP_TABLE_LEVELS ||
+        m_mappedSize < sizeof(MatchupTableHeader) + entries * sizeof(uint16_t)) {
+        close();
+        throw std::runtime_error("Truncated matchup table: " + path);
+    }
+
+    m_header = header;
+    m_data = reinterpret_cast<const uint16_t*>(header + 1);
+}
+
+MatchupTable::~MatchupTable() {
+    close();
+}
+
+MatchupTable::MatchupTable(MatchupTable&& other) noexcept {
+    *this = std::move(other);
+}
+
+MatchupTable& MatchupTable::operator=(MatchupTable&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_header = other.m_header;
+        m_data = other.m_data;
+        m_mapping = other.m_mapping;
+        m_mappedSize = other.m_mappedSize;
+        other.m_header = nullptr;
+        other.m_data = nullptr;
+        other.m_mapping = nullptr;
+        other.m_mappedSize = 0;
+#ifdef _WIN32
+        m_fileHandle = other.m_fileHandle;
+        m_mapHandle = other.m_mapHandle;
+        other.m_fileHandle = nullptr;
+        other.m_mapHandle = nullptr;
+#endif
+    }
+    return *this;
+}
+
+void MatchupTable::close() {
+#ifdef _WIN32
+    if (m_mapping) UnmapViewOfFile(m_mapping);
+    if (m_mapHandle) CloseHandle(m_mapHandle);
+    if (m_fileHandle) CloseHandle(m_fileHandle);
+    m_mapHandle = nullptr;
+    m_fileHandle = nullptr;
+#else
+    if (m_mapping) munmap(m_mapping, m_mappedSize);
+#endif
+    m_header = nullptr;
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_mappedSize = 0;
+}
+
+// ============================================================================
+// Building
+// ============================================================================
+
+float MatchupTable::simulateMatchup(const Pokemon& a, const Pokemon& b, uint32_t samples,
+                                    uint64_t seed, uint16_t maxTurns) {
+    if (samples == 0) return 0.5f;
+
+    BattleEngine engine;
+    uint32_t score = 0;  // 2 per win, 1 per draw
+    for (uint32_t k = 0; k < samples; k++) {
+        engine.reset(deriveSeed(seed, k));
+        engine.setPlayerTeam(&a, 1);
+        engine.setOpponentTeam(&b, 1);
+
+        while (!engine.isTerminal() && engine.getTurnCount() < maxTurns) {
+            engine.step(chooseAIAction(engine, 0));
+        }
+
+        int winner = engine.getWinner();
+        score += winner == 0 ? 2 : (winner < 0 ? 1 : 0);
+    }
+    return score / (2.0f * samples);
+}
+
+void MatchupTable::build(const std::string& path, uint32_t samples, uint32_t seed, size_t numThreads,
+                         uint16_t numMons, uint16_t maxTurns) {
+    numMons = std::min<uint16_t>(numMons, NUM_FRONTIER_MONS);
+
+    // Build each mon once per level instead of once per battle
+    std::vector<Pokemon> mons[MATCHUP_TABLE_LEVELS];
+    for (uint32_t level = 0; level < MATCHUP_TABLE_LEVELS; level++) {
+        mons[level].reserve(numMons);
+        for (uint16_t id = 0; id < numMons; id++) {
+            mons[level].push_back(FactoryGenerator::createPokemon(id, level == 1 ? 100 : 50));
+        }
+    }
+
+    // One work item per (level, row); a row is numMons * samples battles
+    std::vector<uint16_t> table(static_cast<size_t>(MATCHUP_TABLE_LEVELS) * numMons * numMons);
+    parallelFor(MATCHUP_TABLE_LEVELS * numMons, numThreads, 1, [&](size_t begin, size_t end, size_t) {
+        for (size_t row = begin; row < end; row++) {
+            size_t level = row / numMons;
+            uint16_t a = static_cast<uint16_t>(row % numMons);
+            for (uint16_t b = 0; b < numMons; b++) {
+                uint64_t pairSeed = (static_cast<uint64_t>(seed) << 32) | (row * numMons + b);
+                float p = simulateMatchup(mons[level][a], mons[level][b], samples, pairSeed, maxTurns);
+                table[row * numMons + b] = static_cast<uint16_t>(std::lround(p * 65535.0f));
+            }
+        }
+    });
+
+    MatchupTableHeader header{};
+    std::memcpy(header.magic, MATCHUP_MAGIC, 4);
+    header.version = MATCHUP_TABLE_VERSION;
+    header.numMons = numMons;
+    header.numLevels = MATCHUP_TABLE_LEVELS;
+    header.samples = samples;
+    header.seed = seed;
+    header.maxTurns = maxTurns;
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) throw std::runtime_error("Cannot write matchup table: " + path);
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1 &&
+              std::fwrite(table.data(), sizeof(uint16_t), table.size(), f) == table.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) throw std::runtime_error("Failed writing matchup table: " + path);
+}
+
+}  // namespace pkmn
@@ -0,0 +1,164 @@
+#include "matrix_game.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace pkmn {
+
+// Every cell sample is a full rollout (or a nested solve), so hand them out singly
+static constexpr size_t MATRIX_GAME_GRAIN = 1;
+
+// Current regret-matching strategy: positive regrets normalized, uniform if none
+static void strategyFromRegrets(const float* regrets, int n, float* out) {
+    float total = 0.0f;
+    for (int i = 0; i < n; i++) total += regrets[i];
+    for (int i = 0; i < n; i++) out[i] = total > 0.0f ? regrets[i] / total : 1.0f / n;
+}
+
+float solveMatrixGame(const float* payoff, int rows, int cols, uint32_t iterations,
+                      float* rowStrategy, float* colStrategy) {
+    rows = std::clamp(rows, 0, MAX_LEGAL_ACTIONS);
+    cols = std::clamp(cols, 0, MAX_LEGAL_ACTIONS);
+    if (rows == 0 || cols == 0) return 0.0f;
+
+    // RM+ keeps regrets clamped at zero, so they double as strategy weights
+    float rowRegret[MAX_LEGAL_ACTIONS] = {}, colRegret[MAX_LEGAL_ACTIONS] = {};
+    double rowSum[MAX_LEGAL_ACTIONS] = {}, colSum[MAX_LEGAL_ACTIONS] = {};
+    float x[MAX_LEGAL_ACTIONS], y[MAX_LEGAL_ACTIONS];
+
+    for (uint32_t t = 1; t <= iterations; t++) {
+        strategyFromRegrets(rowRegret, rows, x);
+        strategyFromRegrets(colRegret, cols, y);
+
+        float rowUtil[MAX_LEGAL_ACTIONS], colUtil[MAX_LEGAL_ACTIONS] = {};
+        float value = 0.0f;
+        for (int i = 0; i < rows; i++) {
+            float u = 0.0f;
+            for (int j = 0; j < cols; j++) {
+                u += payoff[i * cols + j] * y[j];
+                colUtil[j] += payoff[i * cols + j] * x[i];
+            }
+            rowUtil[i] = u;
+            value += x[i] * u;
+        }
+
+        // The column player minimizes the row player's payoff
+        for (int i = 0; i < rows; i++) rowRegret[i] = std::max(0.0f, rowRegret[i] + rowUtil[i] - value);
+        for (int j = 0; j < cols; j++) colRegret[j] = std::max(0.0f, colRegret[j] + value - colUtil[j]);
+
+        // Linear averaging: later iterates are closer to equilibrium
+        for (int i = 0; i < rows; i++) rowSum[i] += static_cast<double>(t) * x[i];
+        for (int j = 0; j < cols; j++) colSum[j] += static_cast<double>(t) * y[j];
+    }
+
+    double rowTotal = 0.0, colTotal = 0.0;
+    for (int i = 0; i < rows; i++) rowTotal += rowSum[i];
+    for (int j = 0; j < cols; j++) colTotal += colSum[j];
+    for (int i = 0; i < rows; i++) rowStrategy[i] = rowTotal > 0.0 ? static_cast<float>(rowSum[i] / rowTotal) : 1.0f / rows;
+    for (int j = 0; j < cols; j++) colStrategy[j] = colTotal > 0.0 ? static_cast<float>(colSum[j] / colTotal) : 1.0f / cols;
+
+    float value = 0.0f;
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++) value += rowStrategy[i] * payoff[i * cols + j] * colStrategy[j];
+    return value;
+}
+
+static float solveValue(const BattleEngine& engine, uint8_t depth, uint32_t seed, const MatrixGameConfig& config);
+
+// Player's result after one joint action from `engine` (which is consumed)
+static float evaluateJoint(BattleEngine& engine, Action playerAction, Action opponentAction, uint8_t depth,
+                           uint32_t seed, const MatrixGameConfig& config) {
+    engine.stepBoth(playerAction, opponentAction);
+    if (engine.isTerminal()) return outcomeValue(engine);
+    if (depth <= 1) {
+        uint16_t cap = static_cast<uint16_t>(std::min<uint32_t>(
+            UINT16_MAX, static_cast<uint32_t>(engine.getTurnCount()) + config.rolloutMaxTurns));
+        playOut(engine, config.rolloutPolicy, config.rolloutPolicy, cap);
+        return outcomeValue(engine);
+    }
+    return solveValue(engine, depth - 1, seed, config);
+}
+
+// Serial nested solve for depth-limited cells
+static float solveValue(const BattleEngine& engine, uint8_t depth, uint32_t seed, const MatrixGameConfig& config) {
+    if (engine.isTerminal()) return outcomeValue(engine);
+
+    Action rowActions[MAX_LEGAL_ACTIONS], colActions[MAX_LEGAL_ACTIONS];
+    int rows = engine.getLegalActions(0, rowActions);
+    int cols = engine.getLegalActions(1, colActions);
+
+    float payoff[MAX_LEGAL_ACTIONS * MAX_LEGAL_ACTIONS];
+    const uint32_t samples = std::max<uint32_t>(config.samples, 1);
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            float total = 0.0f;
+            for (uint32_t s = 0; s < samples; s++) {
+                uint32_t sampleSeed = deriveSeed(seed, depth, s);
+                BattleEngine copy = engine;
+                copy.setRngState(sampleSeed);
+                total += evaluateJoint(copy, rowActions[i], colActions[j], depth, sampleSeed, config);
+            }
+            payoff[i * cols + j] = total / samples;
+        }
+    }
+
+    float rowStrategy[MAX_LEGAL_ACTIONS], colStrategy[MAX_LEGAL_ACTIONS];
+    return solveMatrixGame(payoff, rows, cols, config.solverIterations, rowStrategy, colStrategy);
+}
+
+MatrixGameSolution solveTurn(const BattleEngine& engine, const MatrixGameConfig& config) {
+    MatrixGameSolution out{};
+    if (engine.isTerminal()) {
+        out.value = outcomeValue(engine);
+        return out;
+    }
+
+    out.rows = engine.getLegalActions(0, out.rowActions);
+    out.cols = engine.getLegalActions(1, out.colActions);
+    const size_t cells = static_cast<size_t>(out.rows) * out.cols;
+    const uint32_t samples = std::max<uint32_t>(config.samples, 1);
+    const uint8_t depth = std::max<uint8_t>(config.depth, 1);
+
+    // One slot per (cell, sample), so the result doesn't depend on thread count
+    std::vector<float> results(cells * samples);
+    parallelFor(results.size(), config.numThreads, MATRIX_GAME_GRAIN, [&](size_t begin, size_t end, size_t) {
+        for (size_t k = begin; k < end; k++) {
+            size_t cell = k / samples;
+            uint32_t s = static_cast<uint32_t>(k % samples);
+            // Common random numbers: sample s uses the same seed in every cell
+            uint32_t sampleSeed = deriveSeed(config.seed, 0, s);
+            BattleEngine copy = engine;
+            copy.setRngState(sampleSeed);
+            results[k] = evaluateJoint(copy, out.rowActions[cell / out.cols], out.colActions[cell % out.cols],
+                                       depth, sampleSeed, config);
+        }
+    });
+
+    float flat[MAX_LEGAL_ACTIONS * MAX_LEGAL_ACTIONS];
+    for (size_t cell = 0; cell < cells; cell++) {
+        float total = 0.0f;
+        for (uint32_t s = 0; s < samples; s++) total += results[cell * samples + s];
+        flat[cell] = total / samples;
+        out.payoff[cell / out.cols][cell % out.cols] = flat[cell];
+    }
+
+    out.value = solveMatrixGame(flat, out.rows, out.cols, config.solverIterations, out.rowStrategy, out.colStrategy);
+
+    // Best-response gains against the returned strategies
+    float bestRow = 0.0f, bestCol = 1.0f;
+    for (int i = 0; i < out.rows; i++) {
+        float u = 0.0f;
+        for (int j = 0; j < out.cols; j++) u += flat[i * out.cols + j] * out.colStrategy[j];
+        bestRow = std::max(bestRow, u);
+    }
+    for (int j = 0; j < out.cols; j++) {
+        float u = 0.0f;
+        for (int i = 0; i < out.rows; i++) u += out.rowStrategy[i] * flat[i * out.cols + j];
+        bestCol = std::min(bestCol, u);
+    }
+    out.exploitability = std::max(0.0f, bestRow - bestCol);
+    return out;
+}
+
+}  // namespace pkmn
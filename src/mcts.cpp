@@ -0,0 +1,277 @@
+#include "mcts.hpp"
+#include "factory.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+#include "transposition.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace pkmn {
+
+enum : uint8_t { NODE_LEAF = 0, NODE_EXPANDING = 1, NODE_EXPANDED = 2 };
+
+// Seed streams, so chance outcomes and determinizations never share seeds
+enum : uint64_t { STREAM_CHANCE = 0, STREAM_DETERMINIZE = 1 };
+
+// Values are accumulated as fixed point so backpropagation is a plain atomic add
+static constexpr int64_t VALUE_SCALE = 1 << 16;
+
+// Root is node 0, so a child block index of 0 means "not allocated"
+static constexpr uint32_t ROOT_NODE = 0;
+
+size_t MctsSearch::nodesForBudget(size_t bytes) {
+    return bytes / sizeof(Node);
+}
+
+MctsSearch::MctsSearch(const MctsConfig& config) : m_config(config) {
+    if (m_config.memoryBudgetBytes > 0) m_config.maxNodes = nodesForBudget(m_config.memoryBudgetBytes);
+    m_config.maxNodes = std::max<size_t>(m_config.maxNodes, 1);
+    m_config.virtualLoss = std::max<uint32_t>(m_config.virtualLoss, 1);
+    m_nodes.reset(new Node[m_config.maxNodes]);
+    m_pool.reset(new ThreadPool(m_config.numThreads));
+}
+
+MctsSearch::~MctsSearch() = default;
+
+void MctsSearch::resetNode(Node& node, float prior) {
+    node.visits.store(0, std::memory_order_relaxed);
+    node.valueSum.store(0, std::memory_order_relaxed);
+    node.firstChild.store(0, std::memory_order_relaxed);
+    node.state.store(NODE_LEAF, std::memory_order_relaxed);
+    node.prior = prior;
+}
+
+uint32_t MctsSearch::allocateChildren() {
+    // Cheap pre-check so a full arena isn't hammered with failing bumps
+    const size_t capacity = m_config.maxNodes;
+    if (m_nextNode.load(std::memory_order_relaxed) + MCTS_NUM_ACTIONS > capacity) return 0;
+    uint32_t first = m_nextNode.fetch_add(MCTS_NUM_ACTIONS, std::memory_order_relaxed);
+    if (first + MCTS_NUM_ACTIONS > capacity) return 0;
+    return first;
+}
+
+void MctsSearch::determinize(BattleEngine& engine, uint32_t seed) const {
+    const BattleState& state = engine.getState();
+
+    // Everything the player has seen is fixed; Factory teams never repeat a species
+    SpeciesSet known;
+    uint8_t hidden = 0;
+    for (uint8_t i = 0; i < state.teamSizes[0]; i++) known.set(state.teams[0][i].species);
+    for (uint8_t i = 0; i < state.teamSizes[1]; i++) {
+        if (state.revealedMask[1] & (1u << i)) known.set(state.teams[1][i].species);
+        else hidden |= static_cast<uint8_t>(1u << i);
+    }
+    if (hidden == 0) return;
+
+    FactoryGenerator::OpponentTeam ids{};
+    int count = FactoryGenerator::generateOpponentTeam(seed, m_config.challengeNum, 0, m_config.isOpenLevel,
+                                                       known, ids);
+    const int level = m_config.isOpenLevel ? 100 : 50;
+    int next = 0;
+    for (uint8_t i = 0; i < state.teamSizes[1] && next < count; i++) {
+        if (hidden & (1u << i)) {
+            engine.setPartyMember(1, i, FactoryGenerator::createPokemon(ids[next++], level));
+        }
+    }
+}
+
+float MctsSearch::evaluateLeaf(BattleEngine& engine, float* priors) const {
+    if (m_config.evaluator) {
+        return std::clamp(m_config.evaluator(engine, priors), 0.0f, 1.0f);
+    }
+    uint16_t cap = static_cast<uint16_t>(std::min<uint32_t>(
+        UINT16_MAX, static_cast<uint32_t>(engine.getTurnCount()) + m_config.rolloutMaxTurns));
+    playOut(engine, m_config.rolloutPolicy, cap);
+    return outcomeValue(engine);
+}
+
+float MctsSearch::evaluateLeafShared(BattleEngine& engine, float* priors) const {
+    TranspositionTable* table = m_config.table;
+    if (!table) return evaluateLeaf(engine, priors);
+
+    const uint64_t key = engine.getHash();  // The rollout consumes the engine
+    TTEntry entry;
+    const bool found = table->probe(key, entry);
+    if (found && entry.bound == Bound::Exact && entry.depth == TT_DEPTH_SOLVED) return entry.value;  // Solved
+    if (found && entry.bound == Bound::None && entry.visits >= m_config.tableTrustVisits) return entry.value;
+
+    float value = evaluateLeaf(engine, priors);
+    if (found && entry.bound == Bound::Exact) {
+        // A depth-limited search value counts as earlier samples; the search keeps its entry
+        const uint32_t weight = std::max<uint32_t>(entry.visits, 1);
+        return (entry.value * weight + value) / (weight + 1);
+    }
+    if (found && entry.bound != Bound::None) return value;  // Keep the search bound
+
+    // Running mean; a concurrent update of the same state may be lost
+    if (found) {
+        value = (entry.value * entry.visits + value) / (entry.visits + 1);
+    } else {
+        entry = TTEntry{};
+    }
+    entry.value = value;
+    entry.visits++;
+    table->store(key, entry);
+    return value;
+}
+
+int MctsSearch::selectChild(const Node& parent, const Action* legal, int count) const {
+    const Node* children = &m_nodes[parent.firstChild.load(std::memory_order_relaxed)];
+    const double parentVisits = std::max<uint32_t>(parent.visits.load(std::memory_order_relaxed), 1);
+    const double c = m_config.exploration;
+    const bool puct = m_config.selection == SelectionRule::PUCT;
+    const double logN = std::log(parentVisits);
+    const double sqrtN = std::sqrt(parentVisits);
+
+    int best = 0;
+    double bestScore = -1.0;
+    for (int i = 0; i < count; i++) {
+        const Node& child = children[static_cast<uint8_t>(legal[i].type)];
+        uint32_t n = child.visits.load(std::memory_order_relaxed);
+        // Pending virtual visits carry no value, so they pull Q down
+        double q = n > 0 ? child.valueSum.load(std::memory_order_relaxed) / double(VALUE_SCALE * n) : 0.5;
+        double score;
+        if (puct) {
+            score = q + c * child.prior * sqrtN / (1.0 + n);
+        } else {
+            if (n == 0) return i;  // Try every legal action once first
+            score = q + c * std::sqrt(logN / n);
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+void MctsSearch::runWorker(const BattleEngine& root, size_t /*worker*/) {
+    const uint32_t vl = m_config.virtualLoss;
+    const bool timed = m_config.timeBudgetMs > 0.0;
+    std::vector<uint32_t> path(static_cast<size_t>(m_config.maxDepth) + 1);
+
+    for (;;) {
+        uint32_t iteration = m_iterationsStarted.fetch_add(1, std::memory_order_relaxed);
+        if (m_config.iterations > 0 && iteration >= m_config.iterations) break;
+        if (timed && std::chrono::steady_clock::now() >= m_deadline) break;
+
+        // Open loop: replay the path on a fresh copy with this iteration's chance outcomes
+        BattleEngine engine = root;
+        engine.setRngState(deriveSeed(m_config.seed, STREAM_CHANCE, iteration));
+        if (m_config.determinize) determinize(engine, deriveSeed(m_config.seed, STREAM_DETERMINIZE, iteration));
+
+        size_t depth = 0;
+        path[0] = ROOT_NODE;
+        m_nodes[ROOT_NODE].visits.fetch_add(vl, std::memory_order_relaxed);
+
+        float value;
+        for (;;) {
+            Node& node = m_nodes[path[depth]];
+            if (engine.isTerminal()) {
+                value = outcomeValue(engine);
+                break;
+            }
+
+            Action legal[MAX_LEGAL_ACTIONS];
+            int count = engine.getLegalActions(0, legal);
+
+            if (node.state.load(std::memory_order_acquire) != NODE_EXPANDED) {
+                float priors[MCTS_NUM_ACTIONS] = {};
+                for (int i = 0; i < count; i++) priors[static_cast<uint8_t>(legal[i].type)] = 1.0f / count;
+
+                // One thread expands; the others just evaluate this leaf,
+                // except at the root, where the value would reach no child
+                uint8_t expected = NODE_LEAF;
+                bool expand = depth < m_config.maxDepth &&
+                              node.state.compare_exchange_strong(expected, NODE_EXPANDING,
+                                                                 std::memory_order_acq_rel);
+                if (!expand && depth == 0 && expected != NODE_LEAF) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                value = evaluateLeafShared(engine, priors);
+
+                if (expand) {
+                    uint32_t first = allocateChildren();
+                    if (first == 0) {
+                        node.state.store(NODE_LEAF, std::memory_order_release);  // Arena full
+                    } else {
+                        for (int a = 0; a < MCTS_NUM_ACTIONS; a++) resetNode(m_nodes[first + a], priors[a]);
+                        node.firstChild.store(first, std::memory_order_relaxed);
+                        node.state.store(NODE_EXPANDED, std::memory_order_release);
+                    }
+                }
+                break;
+            }
+
+            int pick = selectChild(node, legal, count);
+            uint32_t child = node.firstChild.load(std::memory_order_relaxed) + static_cast<uint8_t>(legal[pick].type);
+            m_nodes[child].visits.fetch_add(vl, std::memory_order_relaxed);
+            path[++depth] = child;
+            engine.step(legal[pick]);
+        }
+
+        // Backpropagate, turning the pending virtual visits into one real visit
+        int64_t fixed = static_cast<int64_t>(std::lround(value * VALUE_SCALE));
+        for (size_t d = 0; d <= depth; d++) {
+            Node& node = m_nodes[path[d]];
+            node.valueSum.fetch_add(fixed, std::memory_order_relaxed);
+            if (vl != 1) node.visits.fetch_sub(vl - 1, std::memory_order_relaxed);
+        }
+        m_iterationsDone.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+MctsResult MctsSearch::search(const BattleEngine& root) {
+    auto start = std::chrono::steady_clock::now();
+    m_deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(m_config.timeBudgetMs));
+    m_iterationsStarted.store(0, std::memory_order_relaxed);
+    m_iterationsDone.store(0, std::memory_order_relaxed);
+    m_nextNode.store(1, std::memory_order_relaxed);
+    resetNode(m_nodes[ROOT_NODE], 1.0f);
+
+    // Without any budget the search would never stop
+    const bool unbounded = m_config.iterations == 0 && m_config.timeBudgetMs <= 0.0;
+    if (!unbounded && !root.isTerminal()) {
+        m_pool->parallelFor(m_pool->size(), 1, [&](size_t, size_t, size_t worker) {
+            runWorker(root, worker);
+        });
+    }
+
+    MctsResult result{};
+    result.iterations = m_iterationsDone.load(std::memory_order_relaxed);
+    result.nodesUsed = static_cast<uint32_t>(
+        std::min<size_t>(m_nextNode.load(std::memory_order_relaxed), m_config.maxNodes));
+    result.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const Node& rootNode = m_nodes[ROOT_NODE];
+    uint32_t first = rootNode.state.load(std::memory_order_acquire) == NODE_EXPANDED ?
+        rootNode.firstChild.load(std::memory_order_relaxed) : 0;
+    if (first != 0) {
+        for (int a = 0; a < MCTS_NUM_ACTIONS; a++) {
+            const Node& child = m_nodes[first + a];
+            uint32_t n = child.visits.load(std::memory_order_relaxed);
+            result.visits[a] = n;
+            result.values[a] = n > 0 ?
+                static_cast<float>(child.valueSum.load(std::memory_order_relaxed) / double(VALUE_SCALE * n)) : 0.0f;
+        }
+    }
+
+    Action legal[MAX_LEGAL_ACTIONS];
+    int count = root.getLegalActions(0, legal);
+    result.bestAction = count > 0 ? legal[0] : Action{ActionType::Move1};
+    uint32_t bestVisits = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t n = result.visits[static_cast<uint8_t>(legal[i].type)];
+        if (n > bestVisits) {
+            bestVisits = n;
+            result.bestAction = legal[i];
+        }
+    }
+    return result;
+}
+
+}  // namespace pkmn
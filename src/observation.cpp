@@ -0,0 +1,36 @@
+#include "observation.hpp"
+#include <algorithm>
+
+namespace pkmn {
+
+void encodeObservation(const BattleState& state, uint8_t side, float* out) {
+    const uint8_t foe = side ^ 1;
+    const Pokemon& own = state.getActivePokemon(side);
+    const Pokemon& other = state.getActivePokemon(foe);
+
+    out[0] = static_cast<float>(own.currentHP) / std::max<int>(1, own.maxHP);
+    out[1] = static_cast<float>(other.currentHP) / std::max<int>(1, other.maxHP);
+    out[2] = own.species / 412.0f;
+    out[3] = other.species / 412.0f;
+    for (int i = 0; i < BATTLE_STAT_COUNT; i++) {
+        out[4 + i] = state.active[side].statStages[i] / 6.0f;
+        out[11 + i] = state.active[foe].statStages[i] / 6.0f;
+    }
+    for (int i = 0; i < 4; i++) {
+        out[18 + i] = own.moves[i] / 355.0f;
+        out[22 + i] = own.pp[i] / 40.0f;
+    }
+    out[26] = 0.0f;
+    out[27] = 0.0f;
+    out[28] = state.countRemaining(side) / 3.0f;
+    out[29] = state.countRemaining(foe) / 3.0f;
+}
+
+void encodeActionMask(const BattleEngine& engine, uint8_t side, uint8_t* out) {
+    std::fill(out, out + NUM_ACTION_TYPES, 0);
+    Action legal[MAX_LEGAL_ACTIONS];
+    int count = engine.getLegalActions(side, legal);
+    for (int i = 0; i < count; i++) out[static_cast<int>(legal[i].type)] = 1;
+}
+
+}  // namespace pkmn
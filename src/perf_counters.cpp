@@ -0,0 +1,150 @@
+#include "perf_counters.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace pkmn {
+
+static const char* const PERF_PHASE_NAMES[PERF_PHASE_COUNT] = {
+    "turn", "turn_order", "ai_decision", "execute_move", "damage", "end_of_turn",
+};
+
+bool perfCountersEnabled() {
+#ifdef PKMN_PERF_COUNTERS
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* perfPhaseName(PerfPhase phase) {
+    int index = static_cast<int>(phase);
+    return index < PERF_PHASE_COUNT ? PERF_PHASE_NAMES[index] : "unknown";
+}
+
+#ifdef PKMN_PERF_COUNTERS
+
+namespace {
+
+// Threads beyond this share one block through atomic adds
+constexpr int PERF_MAX_THREADS = 256;
+
+struct alignas(64) PerfBlock {
+    std::atomic<uint64_t> calls[PERF_PHASE_COUNT];
+    std::atomic<uint64_t> ticks[PERF_PHASE_COUNT];
+    std::atomic<bool> inUse;
+};
+
+// Zero-initialized statics: blocks are handed out to threads and returned,
+// zeroed, when the thread exits; `g_retired` keeps what exited threads counted
+PerfBlock g_blocks[PERF_MAX_THREADS];
+PerfBlock g_retired;
+PerfBlock g_shared;
+
+void addBlock(PerfBlock& to, int phase, uint64_t calls, uint64_t ticks) {
+    to.calls[phase].fetch_add(calls, std::memory_order_relaxed);
+    to.ticks[phase].fetch_add(ticks, std::memory_order_relaxed);
+}
+
+struct ThreadSlot {
+    PerfBlock* block = nullptr;
+    bool owned = false;
+
+    PerfBlock* acquire() {
+        for (PerfBlock& candidate : g_blocks) {
+            bool expected = false;
+            if (!candidate.inUse.load(std::memory_order_relaxed) &&
+                candidate.inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                owned = true;
+                return block = &candidate;
+            }
+        }
+        return block = &g_shared;
+    }
+
+    ~ThreadSlot() {
+        if (!owned) return;
+        for (int p = 0; p < PERF_PHASE_COUNT; p++) {
+            uint64_t calls = block->calls[p].exchange(0, std::memory_order_relaxed);
+            uint64_t ticks = block->ticks[p].exchange(0, std::memory_order_relaxed);
+            addBlock(g_retired, p, calls, ticks);
+        }
+        block->inUse.store(false, std::memory_order_release);
+    }
+};
+
+thread_local ThreadSlot t_slot;
+
+}  // namespace
+
+void perfRecord(PerfPhase phase, uint64_t ticks) {
+    PerfBlock* block = t_slot.block ? t_slot.block : t_slot.acquire();
+    const int p = static_cast<int>(phase);
+    if (t_slot.owned) {
+        // Only this thread writes the block: no read-modify-write needed
+        block->calls[p].store(block->calls[p].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        block->ticks[p].store(block->ticks[p].load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+    } else {
+        addBlock(*block, p, 1, ticks);
+    }
+}
+
+PerfCounters getPerfCounters() {
+    PerfCounters out;
+    auto add = [&out](const PerfBlock& block) {
+        for (int p = 0; p < PERF_PHASE_COUNT; p++) {
+            out.phases[p].calls += block.calls[p].load(std::memory_order_relaxed);
+            out.phases[p].ticks += block.ticks[p].load(std::memory_order_relaxed);
+        }
+    };
+    for (const PerfBlock& block : g_blocks) add(block);
+    add(g_retired);
+    add(g_shared);
+
+    const double rate = perfTicksPerSecond();
+    for (PerfCounter& counter : out.phases) counter.seconds = counter.ticks / rate;
+    return out;
+}
+
+void resetPerfCounters() {
+    auto zero = [](PerfBlock& block) {
+        for (int p = 0; p < PERF_PHASE_COUNT; p++) {
+            block.calls[p].store(0, std::memory_order_relaxed);
+            block.ticks[p].store(0, std::memory_order_relaxed);
+        }
+    };
+    for (PerfBlock& block : g_blocks) zero(block);
+    zero(g_retired);
+    zero(g_shared);
+}
+
+#else
+
+PerfCounters getPerfCounters() { return {}; }
+
+void resetPerfCounters() {}
+
+#endif
+
+#ifdef PKMN_PERF_SCOPES
+
+double perfTicksPerSecond() {
+    static const double rate = [] {
+        using Clock = std::chrono::steady_clock;
+        const auto start = Clock::now();
+        const uint64_t startTicks = perfTicks();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const uint64_t ticks = perfTicks() - startTicks;
+        const double secs = std::chrono::duration<double>(Clock::now() - start).count();
+        return secs > 0.0 && ticks > 0 ? ticks / secs : 1e9;
+    }();
+    return rate;
+}
+
+#else
+
+double perfTicksPerSecond() { return 0.0; }
+
+#endif
+
+}  // namespace pkmn
@@ -0,0 +1,74 @@
+#include "policy.hpp"
+#include "ai.hpp"
+#include "data.hpp"
+#include "constants.hpp"
+#include <algorithm>
+
+namespace pkmn {
+
+static Action chooseMaxDamage(BattleEngine& engine, uint8_t side) {
+    Action legal[MAX_LEGAL_ACTIONS];
+    int count = engine.getLegalActions(side, legal);
+
+    const Pokemon& mon = engine.getState().getActivePokemon(side);
+    int bestScore = -1;
+    Action best = legal[0];  // First legal move if nothing does damage
+    for (int i = 0; i < count; i++) {
+        if (!legal[i].isMove()) continue;
+        uint16_t moveId = legal[i].type == ActionType::Struggle ?
+            static_cast<uint16_t>(MOVE_STRUGGLE) : static_cast<uint16_t>(mon.moves[legal[i].getMoveIndex()]);
+        const MoveData& move = getMoveData(moveId);
+
+        // Expected damage on the top roll, scaled by accuracy (0 = never misses)
+        int damage = engine.calculateDamageWithRolls(side, 1 - side, moveId, false, 100);
+        int score = damage * (move.accuracy > 0 ? move.accuracy : 100);
+        if (score > bestScore) {
+            bestScore = score;
+            best = legal[i];
+        }
+    }
+    return best;
+}
+
+Action choosePolicyAction(BattleEngine& engine, uint8_t side, const Policy& policy) {
+    switch (policy.kind) {
+        case PolicyKind::Random: {
+            Action legal[MAX_LEGAL_ACTIONS];
+            int count = engine.getLegalActions(side, legal);
+            return legal[engine.randomRange(count, RngTag::Policy)];
+        }
+        case PolicyKind::FixedIndex: {
+            Action legal[MAX_LEGAL_ACTIONS];
+            int count = engine.getLegalActions(side, legal);
+            return legal[std::min<int>(policy.actionIndex, count - 1)];
+        }
+        case PolicyKind::MaxDamage:
+            return chooseMaxDamage(engine, side);
+        case PolicyKind::ScriptedAI:
+        default:
+            return chooseAIAction(engine, side);
+    }
+}
+
+int playOut(BattleEngine& engine, PolicyKind playerPolicy, uint16_t maxTurns) {
+    while (!engine.isTerminal() && engine.getTurnCount() < maxTurns) {
+        engine.step(choosePolicyAction(engine, 0, playerPolicy));
+    }
+    return engine.getWinner();
+}
+
+int playOut(BattleEngine& engine, PolicyKind playerPolicy, PolicyKind opponentPolicy, uint16_t maxTurns) {
+    while (!engine.isTerminal() && engine.getTurnCount() < maxTurns) {
+        Action playerAction = choosePolicyAction(engine, 0, playerPolicy);
+        Action opponentAction = choosePolicyAction(engine, 1, opponentPolicy);
+        engine.stepBoth(playerAction, opponentAction);
+    }
+    return engine.getWinner();
+}
+
+float outcomeValue(const BattleEngine& engine) {
+    int winner = engine.getWinner();
+    return winner == 0 ? 1.0f : (winner == 1 ? 0.0f : 0.5f);
+}
+
+}  // namespace pkmn
@@ -1,15 +1,57 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
+#include <algorithm>
+#include <memory>
+#include <string>
 
 #include "battle_engine.hpp"
+#include "endgame.hpp"
+#include "evaluator.hpp"
+#include "expectiminimax.hpp"
 #include "factory.hpp"
+#include "lookahead.hpp"
+#include "matchup_table.hpp"
+#include "matrix_game.hpp"
+#include "observation.hpp"
+#include "perf_counters.hpp"
+#include "rng.hpp"
+#include "trace.hpp"
+#include "trajectory.hpp"
+#include "mcts.hpp"
+#include "transposition.hpp"
 #include "types.hpp"
 #include "constants.hpp"
 
 namespace py = pybind11;
 using namespace pkmn;
 
+// Frontier mon ids from Python; getFrontierMon() would map bad ids to mon 0
+static void checkFrontierIds(const uint16_t* ids, size_t count, const char* name) {
+    for (size_t i = 0; i < count; i++) {
+        if (ids[i] >= NUM_FRONTIER_MONS) throw py::index_error(std::string(name) + " has a frontier mon id out of range");
+    }
+}
+
+// LookaheadResult as a dict of per-action arrays
+static py::dict lookaheadToDict(const LookaheadResult& result) {
+    py::list actions;
+    for (int a = 0; a < result.count; a++) actions.append(result.actions[a]);
+    auto array = [&](const float* values) {
+        py::array_t<float> out(result.count);
+        std::copy(values, values + result.count, out.mutable_data());
+        return out;
+    };
+    py::dict out;
+    out["actions"] = actions;
+    out["samples"] = result.samples;
+    out["win_rate"] = array(result.winRate);
+    out["loss_rate"] = array(result.lossRate);
+    out["player_hp_delta"] = array(result.playerHPDelta);
+    out["opponent_hp_delta"] = array(result.opponentHPDelta);
+    return out;
+}
+
 PYBIND11_MODULE(pybattle_native, m) {
     m.doc() = "Pokemon Emerald Battle Simulator";
 
@@ -27,6 +69,16 @@ PYBIND11_MODULE(pybattle_native, m) {
         .value("Struggle", ActionType::Struggle)
         .export_values();
     
+    py::enum_<RngMode>(m, "RngMode")
+        .value("GameLCG", RngMode::GameLCG)
+        .value("Counter", RngMode::Counter);
+
+    py::enum_<PolicyKind>(m, "PolicyKind")
+        .value("ScriptedAI", PolicyKind::ScriptedAI)
+        .value("Random", PolicyKind::Random)
+        .value("MaxDamage", PolicyKind::MaxDamage)
+        .value("FixedIndex", PolicyKind::FixedIndex);
+    
     // Helper to allow implicit conversion from int to Action
     py::class_<Action>(m, "Action")
         .def(py::init<ActionType>())
@@ -83,6 +135,8 @@ PYBIND11_MODULE(pybattle_native, m) {
             return s.active[side];
         }, py::return_value_policy::reference)
         .def_readonly("turn_number", &BattleState::turnNumber)
+        .def_readonly("hash", &BattleState::hash)
+        .def("get_revealed_mask", [](const BattleState& s, int side) { return s.revealedMask[side]; })
         .def("is_terminal", &BattleState::isTerminal)
         .def("get_winner", &BattleState::getWinner)
         // Access teams?
@@ -100,8 +154,20 @@ PYBIND11_MODULE(pybattle_native, m) {
             self.setOpponentTeam(mons.data(), mons.size());
         })
         .def("get_state", &BattleEngine::getState, py::return_value_policy::reference)
+        .def("get_hash", &BattleEngine::getHash)
         .def("step", &BattleEngine::step)
-        .def("get_legal_actions", &BattleEngine::getLegalActions);
+        .def("step_both", &BattleEngine::stepBoth, py::arg("player_action"), py::arg("opponent_action"))
+        .def("set_opponent_policy", [](BattleEngine& self, PolicyKind kind, uint8_t actionIndex) {
+            self.setOpponentPolicy(Policy(kind, actionIndex));
+        }, py::arg("kind"), py::arg("action_index") = 0)
+        .def("get_legal_actions", static_cast<std::vector<Action> (BattleEngine::*)() const>(
+            &BattleEngine::getLegalActions))
+        .def("set_rng_state", &BattleEngine::setRngState, py::arg("state"))
+        .def("advance_rng", &BattleEngine::advanceRng, py::arg("draws"))
+        .def("set_rng_mode", &BattleEngine::setRngMode, py::arg("mode"))
+        .def("get_rng_mode", &BattleEngine::getRngMode)
+        .def("seed_counter_rng", &BattleEngine::seedCounterRng, py::arg("key"), py::arg("counter") = 0)
+        .def("get_rng_counter", &BattleEngine::getRngCounter);
 
     // Factory Helper
     struct FactoryHelper {
@@ -134,9 +200,409 @@ PYBIND11_MODULE(pybattle_native, m) {
         .def("generate_opponent_team", &FactoryHelper::generate_opponent_team)
         .def("generate_player_team", &FactoryHelper::generate_player_team);
 
+    // Batched generation: one team per seed, FRONTIER_MONS ids as uint16 rows
+    m.def("generate_rental_pools", [](py::array_t<uint32_t, py::array::c_style | py::array::forcecast> seeds,
+                                      int challengeNum, bool isOpenLevel, size_t numThreads) {
+        if (seeds.ndim() != 1) throw std::runtime_error("Seeds must be 1D array");
+        py::ssize_t count = seeds.shape(0);
+        py::array_t<uint16_t> out({count, static_cast<py::ssize_t>(FactoryGenerator::RENTAL_POOL_SIZE)});
+
+        const uint32_t* seed_ptr = seeds.data();
+        uint16_t* out_ptr = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            FactoryGenerator::generateRentalPools(seed_ptr, count, challengeNum, isOpenLevel, out_ptr, numThreads);
+        }
+        return out;
+    }, py::arg("seeds"), py::arg("challenge_num"), py::arg("is_open_level"), py::arg("num_threads") = 0);
+
+    m.def("generate_opponent_teams", [](py::array_t<uint32_t, py::array::c_style | py::array::forcecast> seeds,
+                                        int challengeNum, int battleNum, bool isOpenLevel,
+                                        py::object excludeIds, size_t numThreads) {
+        if (seeds.ndim() != 1) throw std::runtime_error("Seeds must be 1D array");
+        py::ssize_t count = seeds.shape(0);
+
+        // Optional [N, k] ids whose species the opponents must avoid (e.g. the player's team)
+        py::array_t<uint16_t, py::array::c_style | py::array::forcecast> excludes;
+        const uint16_t* exclude_ptr = nullptr;
+        size_t excludes_per_seed = 0;
+        if (!excludeIds.is_none()) {
+            excludes = py::array_t<uint16_t, py::array::c_style | py::array::forcecast>::ensure(excludeIds);
+            if (!excludes || excludes.ndim() != 2 || excludes.shape(0) != count)
+                throw std::runtime_error("exclude_ids must be a [N, k] array matching seeds");
+            exclude_ptr = excludes.data();
+            excludes_per_seed = excludes.shape(1);
+            checkFrontierIds(exclude_ptr, excludes.size(), "exclude_ids");
+        }
+
+        py::array_t<uint16_t> out({count, static_cast<py::ssize_t>(FactoryGenerator::OPPONENT_TEAM_SIZE)});
+        const uint32_t* seed_ptr = seeds.data();
+        uint16_t* out_ptr = out.mutable_data();
+        {
+            py::gil_scoped_release release;
+            FactoryGenerator::generateOpponentTeams(seed_ptr, count, challengeNum, battleNum, isOpenLevel, out_ptr,
+                                                    exclude_ptr, excludes_per_seed, numThreads);
+        }
+        return out;
+    }, py::arg("seeds"), py::arg("challenge_num"), py::arg("battle_num"), py::arg("is_open_level"),
+       py::arg("exclude_ids") = py::none(), py::arg("num_threads") = 0);
+
+    // Monte Carlo evaluators
+    m.def("evaluate_rental_combos", [](py::array_t<uint16_t, py::array::c_style | py::array::forcecast> pool,
+                                       int challengeNum, bool isOpenLevel, uint32_t samples,
+                                       PolicyKind policy, uint64_t seed, uint16_t maxTurns, size_t numThreads) {
+        if (pool.ndim() != 1 || pool.shape(0) != 6) throw std::runtime_error("pool must have 6 frontier mon ids");
+        EvaluatorConfig config;
+        config.playerPolicy = policy;
+        config.seed = seed;
+        config.maxTurns = maxTurns;
+        config.numThreads = numThreads;
+
+        std::array<WinRateEstimate, NUM_RENTAL_COMBOS> results;
+        const uint16_t* pool_ptr = pool.data();
+        {
+            py::gil_scoped_release release;
+            results = evaluateRentalCombos(pool_ptr, challengeNum, isOpenLevel, samples, config);
+        }
+
+        // Indexed like FactoryHRL_Env.rental_combos
+        py::array_t<float> winRate(NUM_RENTAL_COMBOS), ciLow(NUM_RENTAL_COMBOS), ciHigh(NUM_RENTAL_COMBOS);
+        auto w = winRate.mutable_unchecked<1>();
+        auto lo = ciLow.mutable_unchecked<1>();
+        auto hi = ciHigh.mutable_unchecked<1>();
+        for (int c = 0; c < NUM_RENTAL_COMBOS; c++) {
+            w(c) = results[c].winRate;
+            lo(c) = results[c].ciLow;
+            hi(c) = results[c].ciHigh;
+        }
+        py::dict out;
+        out["win_rate"] = winRate;
+        out["ci_low"] = ciLow;
+        out["ci_high"] = ciHigh;
+        out["samples"] = samples;
+        return out;
+    }, py::arg("pool"), py::arg("challenge_num"), py::arg("is_open_level"), py::arg("samples"),
+       py::arg("policy") = PolicyKind::ScriptedAI, py::arg("seed") = 0, py::arg("max_turns") = 200,
+       py::arg("num_threads") = 0);
+
+    m.def("evaluate_swaps", [](py::array_t<uint16_t, py::array::c_style | py::array::forcecast> team,
+                               py::array_t<uint16_t, py::array::c_style | py::array::forcecast> defeated,
+                               int challengeNum, int battleNum, bool isOpenLevel, uint32_t samples,
+                               PolicyKind policy, uint64_t seed, uint16_t maxTurns, size_t numThreads) {
+        if (team.ndim() != 1 || team.shape(0) != 3 || defeated.ndim() != 1 || defeated.shape(0) != 3)
+            throw std::runtime_error("team and defeated must each have 3 frontier mon ids");
+        if (battleNum < 0 || battleNum >= BATTLES_PER_CHALLENGE)
+            throw py::value_error("battle_num must be in [0, 7)");
+        EvaluatorConfig config;
+        config.playerPolicy = policy;
+        config.seed = seed;
+        config.maxTurns = maxTurns;
+        config.numThreads = numThreads;
+
+        std::array<SwapEstimate, NUM_SWAP_OPTIONS> results;
+        const uint16_t* team_ptr = team.data();
+        const uint16_t* defeated_ptr = defeated.data();
+        {
+            py::gil_scoped_release release;
+            results = evaluateSwaps(team_ptr, defeated_ptr, challengeNum, battleNum, isOpenLevel, samples, config);
+        }
+
+        // Indexed like the SWAP action: 0 = keep, i = P[(i-1)//3] <- O[(i-1)%3]
+        py::array_t<float> survival(NUM_SWAP_OPTIONS), ciLow(NUM_SWAP_OPTIONS), ciHigh(NUM_SWAP_OPTIONS),
+            battlesWon(NUM_SWAP_OPTIONS);
+        auto sv = survival.mutable_unchecked<1>();
+        auto lo = ciLow.mutable_unchecked<1>();
+        auto hi = ciHigh.mutable_unchecked<1>();
+        auto bw = battlesWon.mutable_unchecked<1>();
+        for (int o = 0; o < NUM_SWAP_OPTIONS; o++) {
+            sv(o) = results[o].survival.winRate;
+            lo(o) = results[o].survival.ciLow;
+            hi(o) = results[o].survival.ciHigh;
+            bw(o) = results[o].meanBattlesWon;
+        }
+        py::dict out;
+        out["survival"] = survival;
+        out["ci_low"] = ciLow;
+        out["ci_high"] = ciHigh;
+        out["mean_battles_won"] = battlesWon;
+        out["samples"] = samples;
+        return out;
+    }, py::arg("team"), py::arg("defeated"), py::arg("challenge_num"), py::arg("battle_num"),
+       py::arg("is_open_level"), py::arg("samples"), py::arg("policy") = PolicyKind::ScriptedAI,
+       py::arg("seed") = 0, py::arg("max_turns") = 200, py::arg("num_threads") = 0);
+
+    // MCTS (leaf evaluators are C++-only; Python searches use rollouts)
+    py::enum_<SelectionRule>(m, "SelectionRule")
+        .value("UCT", SelectionRule::UCT)
+        .value("PUCT", SelectionRule::PUCT);
+
+    py::class_<MctsConfig>(m, "MctsConfig")
+        .def(py::init<>())
+        .def_readwrite("iterations", &MctsConfig::iterations)
+        .def_readwrite("time_budget_ms", &MctsConfig::timeBudgetMs)
+        .def_readwrite("selection", &MctsConfig::selection)
+        .def_readwrite("exploration", &MctsConfig::exploration)
+        .def_readwrite("virtual_loss", &MctsConfig::virtualLoss)
+        .def_readwrite("rollout_policy", &MctsConfig::rolloutPolicy)
+        .def_readwrite("rollout_max_turns", &MctsConfig::rolloutMaxTurns)
+        .def_readwrite("max_depth", &MctsConfig::maxDepth)
+        .def_readwrite("num_threads", &MctsConfig::numThreads)
+        .def_readwrite("determinize", &MctsConfig::determinize)
+        .def_readwrite("challenge_num", &MctsConfig::challengeNum)
+        .def_readwrite("is_open_level", &MctsConfig::isOpenLevel)
+        .def_readwrite("max_nodes", &MctsConfig::maxNodes)
+        .def_readwrite("memory_budget_bytes", &MctsConfig::memoryBudgetBytes)
+        .def_readwrite("seed", &MctsConfig::seed);
+
+    py::class_<MctsSearch>(m, "MctsSearch")
+        .def(py::init<const MctsConfig&>(), py::arg("config") = MctsConfig{})
+        .def("search", [](MctsSearch& self, const BattleEngine& engine) {
+            MctsResult result;
+            {
+                py::gil_scoped_release release;
+                result = self.search(engine);
+            }
+            py::array_t<uint32_t> visits(MCTS_NUM_ACTIONS);
+            py::array_t<float> values(MCTS_NUM_ACTIONS);
+            std::copy(result.visits, result.visits + MCTS_NUM_ACTIONS, visits.mutable_data());
+            std::copy(result.values, result.values + MCTS_NUM_ACTIONS, values.mutable_data());
+
+            // visits/values are indexed by ActionType
+            py::dict out;
+            out["action"] = result.bestAction;
+            out["visits"] = visits;
+            out["values"] = values;
+            out["iterations"] = result.iterations;
+            out["nodes_used"] = result.nodesUsed;
+            out["elapsed_ms"] = result.elapsedMs;
+            return out;
+        }, py::arg("engine"))
+        .def_property_readonly("config", &MctsSearch::config)
+        .def_property_readonly("capacity", &MctsSearch::capacity);
+
+    // Simultaneous-move turn solver
+    m.def("solve_turn", [](const BattleEngine& engine, uint32_t samples, uint8_t depth, PolicyKind policy,
+                           uint32_t solverIterations, uint64_t seed, size_t numThreads) {
+        MatrixGameConfig config;
+        config.samples = samples;
+        config.depth = depth;
+        config.rolloutPolicy = policy;
+        config.solverIterations = solverIterations;
+        config.seed = seed;
+        config.numThreads = numThreads;
+
+        MatrixGameSolution sol;
+        {
+            py::gil_scoped_release release;
+            sol = solveTurn(engine, config);
+        }
+
+        py::array_t<float> payoff({sol.rows, sol.cols});
+        py::array_t<float> rowStrategy(sol.rows), colStrategy(sol.cols);
+        auto p = payoff.mutable_unchecked<2>();
+        for (int i = 0; i < sol.rows; i++)
+            for (int j = 0; j < sol.cols; j++) p(i, j) = sol.payoff[i][j];
+        std::copy(sol.rowStrategy, sol.rowStrategy + sol.rows, rowStrategy.mutable_data());
+        std::copy(sol.colStrategy, sol.colStrategy + sol.cols, colStrategy.mutable_data());
+
+        py::dict out;
+        out["player_actions"] = std::vector<Action>(sol.rowActions, sol.rowActions + sol.rows);
+        out["opponent_actions"] = std::vector<Action>(sol.colActions, sol.colActions + sol.cols);
+        out["payoff"] = payoff;
+        out["player_strategy"] = rowStrategy;
+        out["opponent_strategy"] = colStrategy;
+        out["value"] = sol.value;
+        out["exploitability"] = sol.exploitability;
+        return out;
+    }, py::arg("engine"), py::arg("samples") = 32, py::arg("depth") = 1,
+       py::arg("policy") = PolicyKind::MaxDamage, py::arg("solver_iterations") = 2000,
+       py::arg("seed") = 0, py::arg("num_threads") = 0);
+
+    // Expectiminimax (the leaf evaluator is C++-only; Python uses the HP heuristic)
+    m.def("expectiminimax", [](const BattleEngine& engine, uint8_t maxDepth, double timeBudgetMs,
+                               uint8_t damageBuckets, bool branchCrits, bool star2, TranspositionTable* table) {
+        ExpectiminimaxConfig config;
+        config.maxDepth = maxDepth;
+        config.timeBudgetMs = timeBudgetMs;
+        config.chance.damageBuckets = damageBuckets;
+        config.chance.branchCrits = branchCrits;
+        config.star2 = star2;
+        config.table = table;
+
+        ExpectiminimaxResult result;
+        {
+            py::gil_scoped_release release;
+            result = searchExpectiminimax(engine, config);
+        }
+        py::dict out;
+        out["action"] = result.bestAction;
+        out["value"] = result.value;
+        out["depth"] = result.depthReached;
+        out["nodes"] = result.nodes;
+        out["elapsed_ms"] = result.elapsedMs;
+        return out;
+    }, py::arg("engine"), py::arg("max_depth") = 3, py::arg("time_budget_ms") = 0.0,
+       py::arg("damage_buckets") = 4, py::arg("branch_crits") = true, py::arg("star2") = true,
+       py::arg("table") = nullptr);
+
+    // Phase timers (all zero unless built with PERF_COUNTERS)
+    m.def("get_perf_counters", []() {
+        PerfCounters counters = getPerfCounters();
+        py::dict phases;
+        for (int p = 0; p < PERF_PHASE_COUNT; p++) {
+            const PerfCounter& c = counters.phases[p];
+            py::dict phase;
+            phase["calls"] = c.calls;
+            phase["ticks"] = c.ticks;
+            phase["seconds"] = c.seconds;
+            phases[perfPhaseName(static_cast<PerfPhase>(p))] = phase;
+        }
+        py::dict out;
+        out["enabled"] = perfCountersEnabled();
+        out["ticks_per_second"] = perfTicksPerSecond();
+        out["phases"] = phases;
+        return out;
+    });
+    m.def("reset_perf_counters", &resetPerfCounters);
+
+    // Chrome trace recording (no-ops unless built with TRACE_EVENTS)
+    m.def("trace_events_enabled", &traceEventsEnabled);
+    m.def("start_trace", &startTrace);
+    m.def("stop_trace", &stopTrace);
+    m.def("write_chrome_trace", &writeChromeTrace, py::arg("path"),
+          "Write recorded events as Chrome trace JSON; returns the event count");
+
+    m.def("counter_rng_key", &counterRngKey, py::arg("global_seed"), py::arg("env"), py::arg("episode"));
+
+    m.def("emerald_rng_jump", &emeraldRngJump, py::arg("state"), py::arg("draws"));
+    m.def("factory_rng_jump", &factoryRngJump, py::arg("seed"), py::arg("draws"));
+    m.def("rng_trace_enabled", &rngTraceEnabled);
+
+    // One trace for the calling (Python) thread's draws
+    static std::vector<RngDraw> rngTrace;
+    m.def("start_rng_trace", []() {
+        rngTrace.clear();
+        setRngTrace(&rngTrace);
+    });
+    m.def("stop_rng_trace", []() {
+        // List of (turn, tag, value)
+        setRngTrace(nullptr);
+        py::list out;
+        for (const RngDraw& d : rngTrace) out.append(py::make_tuple(d.turn, rngTagName(d.tag), d.value));
+        rngTrace.clear();
+        return out;
+    });
+
+    m.def("playouts", [](const BattleEngine& engine, uint32_t n, PolicyKind policy, uint16_t maxTurns,
+                         uint64_t seed, size_t numThreads) {
+        PlayoutStats stats;
+        {
+            py::gil_scoped_release release;
+            stats = playouts(engine, n, policy, maxTurns, seed, numThreads);
+        }
+        py::dict out;
+        out["win_rate"] = stats.win.winRate;
+        out["ci_low"] = stats.win.ciLow;
+        out["ci_high"] = stats.win.ciHigh;
+        out["capped"] = stats.capped;
+        out["mean_turns"] = stats.meanTurns;
+        out["mean_player_hp"] = stats.meanPlayerHP;
+        out["mean_opponent_hp"] = stats.meanOpponentHP;
+        return out;
+    }, py::arg("engine"), py::arg("n"), py::arg("policy") = PolicyKind::Random, py::arg("max_turns") = 200,
+       py::arg("seed") = 0, py::arg("num_threads") = 0);
+
+    m.def("lookahead_all", [](const BattleEngine& engine, uint32_t samples, uint64_t seed, size_t numThreads) {
+        LookaheadConfig config;
+        config.seed = seed;
+        config.numThreads = numThreads;
+        LookaheadResult result;
+        {
+            py::gil_scoped_release release;
+            result = lookaheadAll(engine, samples, config);
+        }
+        return lookaheadToDict(result);
+    }, py::arg("engine"), py::arg("samples") = 64, py::arg("seed") = 0, py::arg("num_threads") = 0);
+
+    // Shared transposition table (lock-free; usable from several searches at once)
+    py::class_<TranspositionTable>(m, "TranspositionTable")
+        .def(py::init<size_t>(), py::arg("megabytes"))
+        .def("new_generation", &TranspositionTable::newGeneration)
+        .def("clear", &TranspositionTable::clear)
+        .def("hashfull", &TranspositionTable::hashfull, "Permille of sampled entries written this generation")
+        .def("count_used", &TranspositionTable::countUsed, "Entries written this generation (scans the whole table)")
+        .def_property_readonly("generation", &TranspositionTable::generation)
+        .def_property_readonly("capacity", &TranspositionTable::capacity)
+        .def_property_readonly("size_bytes", &TranspositionTable::sizeBytes);
+
+    // Memoized 1v1 endgame solver (policies are indexed by ActionType)
+    py::class_<EndgameSolver>(m, "EndgameSolver")
+        .def(py::init([](uint8_t damageBuckets, bool branchCrits, uint32_t solverIterations) {
+            EndgameConfig config;
+            config.chance.damageBuckets = damageBuckets;
+            config.chance.branchCrits = branchCrits;
+            config.solverIterations = solverIterations;
+            return std::make_unique<EndgameSolver>(config);
+        }), py::arg("damage_buckets") = 16, py::arg("branch_crits") = true, py::arg("solver_iterations") = 2000)
+        .def("solve", [](EndgameSolver& self, const BattleEngine& engine) -> py::object {
+            EndgameSolution solution;
+            bool solved;
+            {
+                py::gil_scoped_release release;
+                solved = self.solve(engine, solution);
+            }
+            if (!solved) return py::none();
+
+            py::array_t<float> playerPolicy(NUM_ACTION_TYPES), opponentPolicy(NUM_ACTION_TYPES);
+            std::copy(solution.playerPolicy, solution.playerPolicy + NUM_ACTION_TYPES, playerPolicy.mutable_data());
+            std::copy(solution.opponentPolicy, solution.opponentPolicy + NUM_ACTION_TYPES,
+                      opponentPolicy.mutable_data());
+            py::dict out;
+            out["value"] = solution.value;
+            out["player_policy"] = playerPolicy;
+            out["opponent_policy"] = opponentPolicy;
+            return out;
+        }, py::arg("engine"), "Value and Nash policies for a 1v1 position, or None if it isn't 1v1")
+        .def("value", &EndgameSolver::value, py::arg("engine"), py::call_guard<py::gil_scoped_release>(),
+             "Player's win probability for a 1v1 position, or -1 if it isn't 1v1")
+        .def("clear", &EndgameSolver::clear)
+        .def("__len__", &EndgameSolver::size);
+
+    // MatchupTable (memory-mapped, read-only)
+    py::class_<MatchupTable>(m, "MatchupTable")
+        .def(py::init<const std::string&>(), py::arg("path"))
+        .def("win_rate", &MatchupTable::winRateAt, py::arg("a"), py::arg("b"), py::arg("is_open_level"),
+             "Raises IndexError for ids outside the table")
+        .def_property_readonly("num_mons", &MatchupTable::numMons)
+        .def_property_readonly("samples", [](const MatchupTable& self) { return self.header().samples; })
+        .def_property_readonly("version", [](const MatchupTable& self) { return self.header().version; })
+        .def("as_array", [](py::object selfObj) {
+            // Zero-copy [levels, mons, mons] uint16 view; keeps the table alive
+            const MatchupTable& self = selfObj.cast<const MatchupTable&>();
+            py::ssize_t n = self.numMons();
+            py::array_t<uint16_t> arr({static_cast<py::ssize_t>(self.header().numLevels), n, n},
+                                      self.data(), selfObj);
+            arr.attr("setflags")(py::arg("write") = false);
+            return arr;
+        }, "Raw fixed-point win rates (divide by 65535), shape [2, num_mons, num_mons]")
+        .def_static("build", &MatchupTable::build, py::arg("path"), py::arg("samples"), py::arg("seed"),
+                    py::arg("num_threads") = 0, py::arg("num_mons") = NUM_FRONTIER_MONS,
+                    py::arg("max_turns") = 200, py::call_guard<py::gil_scoped_release>());
+
     // VecBattleEnv
     py::class_<VecBattleEnv>(m, "VecBattleEnv")
-        .def(py::init<size_t>())
+        .def(py::init<size_t, size_t>(), py::arg("num_envs"), py::arg("num_threads") = 1)
+        .def("set_num_threads", &VecBattleEnv::setNumThreads)
+        .def("set_opponent_policy", [](VecBattleEnv& self, PolicyKind kind, uint8_t actionIndex) {
+            self.setOpponentPolicy(Policy(kind, actionIndex));
+        }, py::arg("kind"), py::arg("action_index") = 0)
+        .def("num_threads", &VecBattleEnv::numThreads)
+        .def("set_rng_mode", &VecBattleEnv::setRngMode, py::arg("mode"))
+        .def("seed_counter_rngs", [](VecBattleEnv& self, uint64_t globalSeed,
+                                     py::array_t<uint64_t, py::array::c_style | py::array::forcecast> episodes) {
+            if (episodes.ndim() != 1) throw std::runtime_error("Episodes must be 1D array");
+            self.seedCounterRngs(globalSeed, episodes.data(), episodes.size());
+        }, py::arg("global_seed"), py::arg("episodes"))
         .def("reset", [](VecBattleEnv& self, py::array_t<uint32_t> seeds) {
             py::buffer_info buf = seeds.request();
             if (buf.ndim != 1) throw std::runtime_error("Seeds must be 1D array");
@@ -157,20 +623,118 @@ PYBIND11_MODULE(pybattle_native, m) {
             auto rewards = py::array_t<float>(count);
             auto dones = py::array_t<bool>(count);
             
-            self.step(action_ptr, 
-                      static_cast<float*>(rewards.request().ptr),
-                      static_cast<bool*>(dones.request().ptr),
-                      count);
+            float* reward_ptr = static_cast<float*>(rewards.request().ptr);
+            bool* done_ptr = static_cast<bool*>(dones.request().ptr);
+            {
+                py::gil_scoped_release release;
+                self.step(action_ptr, reward_ptr, done_ptr, count);
+            }
                       
             return py::make_tuple(rewards, dones);
         })
+        .def("step_both", [](VecBattleEnv& self,
+                             py::array_t<uint8_t, py::array::c_style | py::array::forcecast> actions) {
+            // [N, 2] action indices: column 0 = player, column 1 = opponent
+            if (actions.ndim() != 2 || actions.shape(1) != 2)
+                throw std::runtime_error("Actions must have shape [num_envs, 2]");
+            size_t count = static_cast<size_t>(actions.shape(0));
+            const Action* action_ptr = reinterpret_cast<const Action*>(actions.data());
+
+            auto rewards = py::array_t<float>(count);
+            auto dones = py::array_t<bool>(count);
+            float* reward_ptr = rewards.mutable_data();
+            bool* done_ptr = dones.mutable_data();
+            {
+                py::gil_scoped_release release;
+                self.stepBoth(action_ptr, reward_ptr, done_ptr, count);
+            }
+            return py::make_tuple(rewards, dones);
+        }, py::arg("actions"))
         .def("set_player_team", [](VecBattleEnv& self, size_t idx, const std::vector<Pokemon>& mons) {
             self.setPlayerTeam(idx, mons.data(), mons.size());
         })
         .def("set_opponent_team", [](VecBattleEnv& self, size_t idx, const std::vector<Pokemon>& mons) {
             self.setOpponentTeam(idx, mons.data(), mons.size());
         })
+        .def("set_teams_from_ids", [](VecBattleEnv& self,
+                                      py::array_t<uint16_t, py::array::c_style | py::array::forcecast> ids,
+                                      int level) {
+            if (ids.ndim() != 3 || ids.shape(1) != 2 || ids.shape(2) != FactoryGenerator::OPPONENT_TEAM_SIZE)
+                throw std::runtime_error("ids must be a [N, 2, 3] array");
+            const uint16_t* id_ptr = ids.data();
+            size_t count = ids.shape(0);
+            checkFrontierIds(id_ptr, ids.size(), "ids");
+            py::gil_scoped_release release;
+            self.setTeamsFromIds(id_ptr, count, level);
+        }, py::arg("ids"), py::arg("level"))
+        .def("lookahead_all", [](const VecBattleEnv& self, size_t idx, uint32_t samples, uint64_t seed) {
+            if (idx >= self.size()) throw py::index_error("Environment index out of range");
+            LookaheadResult result;
+            {
+                py::gil_scoped_release release;
+                result = self.lookaheadAll(idx, samples, seed);
+            }
+            return lookaheadToDict(result);
+        }, py::arg("idx"), py::arg("samples") = 64, py::arg("seed") = 0)
+        .def("observe", [](const VecBattleEnv& self, bool aiScores) -> py::tuple {
+            // Player-side [N, OBS_SIZE] observations and [N, NUM_ACTION_TYPES] masks
+            size_t count = self.size();
+            py::array_t<float> obs({count, static_cast<size_t>(OBS_SIZE)});
+            py::array_t<uint8_t> masks({count, static_cast<size_t>(NUM_ACTION_TYPES)});
+            float* obs_ptr = obs.mutable_data();
+            uint8_t* mask_ptr = masks.mutable_data();
+            if (!aiScores) {
+                py::gil_scoped_release release;
+                self.observe(obs_ptr, mask_ptr, nullptr, count);
+                return py::make_tuple(obs, masks);
+            }
+            py::array_t<int8_t> scores({count, size_t(4)});
+            int8_t* score_ptr = scores.mutable_data();
+            {
+                py::gil_scoped_release release;
+                self.observe(obs_ptr, mask_ptr, score_ptr, count);
+            }
+            return py::make_tuple(obs, masks, scores);
+        }, py::arg("ai_scores") = false)
         .def("get_legal_actions", &VecBattleEnv::getLegalActions)
         .def("get_state", &VecBattleEnv::getState, py::return_value_policy::reference)
         .def("size", &VecBattleEnv::size);
+
+    m.attr("OBS_SIZE") = OBS_SIZE;
+    m.def("encode_observation", [](const BattleState& state, uint8_t side) {
+        py::array_t<float> out(OBS_SIZE);
+        encodeObservation(state, side, out.mutable_data());
+        return out;
+    }, py::arg("state"), py::arg("side") = 0);
+
+    py::class_<TrajectoryRecorder>(m, "TrajectoryRecorder")
+        .def(py::init<const std::string&, size_t, bool>(), py::arg("directory"),
+             py::arg("rows_per_shard") = TRAJECTORY_DEFAULT_SHARD_ROWS, py::arg("ai_scores") = true)
+        .def("record_step", [](TrajectoryRecorder& self, VecBattleEnv& env, py::array_t<uint8_t> actions) {
+            // Same contract as VecBattleEnv.step, plus one recorded row per env
+            py::buffer_info act_buf = actions.request();
+            if (act_buf.ndim != 1) throw std::runtime_error("Actions must be 1D array");
+            size_t count = std::min<size_t>(act_buf.size, env.size());
+            const Action* action_ptr = reinterpret_cast<const Action*>(act_buf.ptr);
+
+            auto rewards = py::array_t<float>(count);
+            auto dones = py::array_t<bool>(count);
+            float* reward_ptr = rewards.mutable_data();
+            bool* done_ptr = dones.mutable_data();
+            {
+                py::gil_scoped_release release;
+                self.recordStep(env, action_ptr, reward_ptr, done_ptr, count);
+            }
+            return py::make_tuple(rewards, dones);
+        }, py::arg("env"), py::arg("actions"))
+        .def("close", [](TrajectoryRecorder& self) {
+            py::gil_scoped_release release;
+            self.close();
+        })
+        .def_property_readonly("rows", &TrajectoryRecorder::rows)
+        .def_property_readonly("rows_per_shard", &TrajectoryRecorder::rowsPerShard)
+        .def_property_readonly("directory", &TrajectoryRecorder::directory)
+        .def("__enter__", [](TrajectoryRecorder& self) -> TrajectoryRecorder& { return self; },
+             py::return_value_policy::reference)
+        .def("__exit__", [](TrajectoryRecorder& self, py::args) { self.close(); });
 }
@@ -0,0 +1,206 @@
+#include "replay.hpp"
+#include "factory.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace pkmn {
+
+static constexpr char REPLAY_MAGIC[4] = {'P', 'B', 'R', 'P'};
+
+// A replay is a whole battle (tens of microseconds), so batch a few
+static constexpr size_t REPLAY_GRAIN = 8;
+
+static uint16_t hashCheck(const BattleEngine& engine) {
+    return static_cast<uint16_t>(engine.getHash());
+}
+
+void startReplay(BattleEngine& engine, const Replay& replay) {
+    Pokemon teams[2][3];
+    for (int i = 0; i < 6; i++) {
+        teams[i / 3][i % 3] = FactoryGenerator::createPokemon(replay.teamIds[i], replay.level);
+    }
+    engine.reset(replay.seed);
+    engine.setRngMode(replay.rngMode);
+    engine.setPlayerTeam(teams[0], 3);
+    engine.setOpponentTeam(teams[1], 3);
+    engine.setOpponentPolicy(replay.opponentPolicy);
+    if (replay.rngMode == RngMode::Counter) engine.seedCounterRng(replay.rngKey, replay.rngCounter);
+}
+
+// The generator the battle is played with, taken before its first turn
+static void recordRng(const BattleEngine& engine, Replay& replay) {
+    if (!replay.actions.empty()) return;
+    replay.rngMode = engine.getRngMode();
+    const bool counter = replay.rngMode == RngMode::Counter;
+    replay.rngKey = counter ? engine.getRngKey() : 0;
+    replay.rngCounter = counter ? engine.getRngCounter() : 0;
+}
+
+StepResult recordStep(BattleEngine& engine, Replay& replay, Action playerAction) {
+    recordRng(engine, replay);
+    StepResult result = engine.step(playerAction);
+    replay.actions.push_back(static_cast<uint8_t>(playerAction.type));
+    replay.hashChecks.push_back(hashCheck(engine));
+    replay.winner = static_cast<int8_t>(result.winner);
+    return result;
+}
+
+StepResult recordStepBoth(BattleEngine& engine, Replay& replay, Action playerAction, Action opponentAction) {
+    recordRng(engine, replay);
+    StepResult result = engine.stepBoth(playerAction, opponentAction);
+    replay.bothSides = true;
+    replay.actions.push_back(static_cast<uint8_t>(static_cast<uint8_t>(playerAction.type) |
+                                                  static_cast<uint8_t>(opponentAction.type) << 4));
+    replay.hashChecks.push_back(hashCheck(engine));
+    replay.winner = static_cast<int8_t>(result.winner);
+    return result;
+}
+
+ReplayVerification verifyReplay(const Replay& replay) {
+    ReplayVerification out;
+    BattleEngine engine;
+    startReplay(engine, replay);
+    const size_t turns = std::min(replay.actions.size(), replay.hashChecks.size());
+    for (size_t t = 0; t < turns; t++) {
+        const uint8_t byte = replay.actions[t];
+        Action player{static_cast<ActionType>(byte & 0xF)};
+        if (replay.bothSides) engine.stepBoth(player, Action{static_cast<ActionType>(byte >> 4)});
+        else engine.step(player);
+        out.turns++;
+        if (hashCheck(engine) != replay.hashChecks[t]) {
+            out.divergedTurn = static_cast<int>(t);
+            out.winnerMatches = engine.getWinner() == replay.winner;
+            return out;
+        }
+    }
+    out.winnerMatches = engine.getWinner() == replay.winner;
+    return out;
+}
+
+std::vector<ReplayVerification> verifyReplays(const std::vector<Replay>& replays, size_t numThreads) {
+    std::vector<ReplayVerification> out(replays.size());
+    parallelFor(replays.size(), numThreads, REPLAY_GRAIN, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) out[i] = verifyReplay(replays[i]);
+    });
+    return out;
+}
+
+// ============================================================================
+// Files
+// ============================================================================
+
+ReplayWriter::ReplayWriter(const std::string& path) : m_path(path) {
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) throw std::runtime_error("Cannot write replay file: " + path);
+    ReplayFileHeader header{};
+    std::memcpy(header.magic, REPLAY_MAGIC, 4);
+    header.version = REPLAY_VERSION;
+    if (std::fwrite(&header, sizeof(header), 1, m_file) != 1) {
+        close();
+        throw std::runtime_error("Failed writing replay file: " + path);
+    }
+}
+
+ReplayWriter::~ReplayWriter() {
+    if (m_file) std::fclose(m_file);
+}
+
+void ReplayWriter::write(const Replay& replay) {
+    if (!m_file) throw std::runtime_error("Replay file already closed: " + m_path);
+    if (replay.actions.size() != replay.hashChecks.size() || replay.actions.size() > UINT16_MAX) {
+        throw std::runtime_error("Malformed replay: needs one hash check per action and at most 65535 turns");
+    }
+
+    ReplayRecordHeader header{};
+    header.seed = replay.seed;
+    std::memcpy(header.teamIds, replay.teamIds.data(), sizeof(header.teamIds));
+    header.turns = static_cast<uint16_t>(replay.actions.size());
+    header.level = replay.level;
+    header.flags = replay.bothSides ? REPLAY_BOTH_SIDES : 0;
+    header.opponentPolicy = static_cast<uint8_t>(replay.opponentPolicy.kind);
+    header.opponentIndex = replay.opponentPolicy.actionIndex;
+    header.winner = replay.winner;
+    header.rngMode = static_cast<uint8_t>(replay.rngMode);
+
+    const size_t turns = header.turns;
+    const uint64_t stream[2] = {replay.rngKey, replay.rngCounter};
+    bool ok = std::fwrite(&header, sizeof(header), 1, m_file) == 1 &&
+              (replay.rngMode != RngMode::Counter || std::fwrite(stream, sizeof(stream), 1, m_file) == 1) &&
+              std::fwrite(replay.actions.data(), 1, turns, m_file) == turns &&
+              std::fwrite(replay.hashChecks.data(), sizeof(uint16_t), turns, m_file) == turns;
+    if (!ok) throw std::runtime_error("Failed writing replay file: " + m_path);
+    m_count++;
+}
+
+void ReplayWriter::close() {
+    if (!m_file) return;
+    bool ok = std::fclose(m_file) == 0;
+    m_file = nullptr;
+    if (!ok) throw std::runtime_error("Failed writing replay file: " + m_path);
+}
+
+ReplayReader::ReplayReader(const std::string& path) : m_path(path) {
+    m_file = std::fopen(path.c_str(), "rb");
+    if (!m_file) throw std::runtime_error("Cannot open replay file: " + path);
+    ReplayFileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, m_file) != 1 || std::memcmp(header.magic, REPLAY_MAGIC, 4) != 0) {
+        std::fclose(m_file);
+        m_file = nullptr;
+        throw std::runtime_error("Not a replay file: " + path);
+    }
+    if (header.version != REPLAY_VERSION) {
+        std::fclose(m_file);
+        m_file = nullptr;
+        throw std::runtime_error("Unsupported replay version in " + path);
+    }
+}
+
+ReplayReader::~ReplayReader() {
+    if (m_file) std::fclose(m_file);
+}
+
+bool ReplayReader::next(Replay& out) {
+    ReplayRecordHeader header{};
+    size_t got = std::fread(&header, 1, sizeof(header), m_file);
+    if (got == 0) return false;
+    if (got != sizeof(header)) throw std::runtime_error("Truncated replay file: " + m_path);
+
+    out.seed = header.seed;
+    std::memcpy(out.teamIds.data(), header.teamIds, sizeof(header.teamIds));
+    out.level = header.level;
+    out.opponentPolicy = Policy(static_cast<PolicyKind>(header.opponentPolicy), header.opponentIndex);
+    out.bothSides = (header.flags & REPLAY_BOTH_SIDES) != 0;
+    out.winner = header.winner;
+    if (header.rngMode > static_cast<uint8_t>(RngMode::Counter)) {
+        throw std::runtime_error("Malformed replay file: " + m_path);
+    }
+    out.rngMode = static_cast<RngMode>(header.rngMode);
+    out.rngKey = out.rngCounter = 0;
+    if (out.rngMode == RngMode::Counter) {
+        uint64_t stream[2];
+        if (std::fread(stream, sizeof(stream), 1, m_file) != 1) {
+            throw std::runtime_error("Truncated replay file: " + m_path);
+        }
+        out.rngKey = stream[0];
+        out.rngCounter = stream[1];
+    }
+    out.actions.resize(header.turns);
+    out.hashChecks.resize(header.turns);
+    const size_t turns = header.turns;
+    bool ok = std::fread(out.actions.data(), 1, turns, m_file) == turns &&
+              std::fread(out.hashChecks.data(), sizeof(uint16_t), turns, m_file) == turns;
+    if (!ok) throw std::runtime_error("Truncated replay file: " + m_path);
+    return true;
+}
+
+std::vector<Replay> readReplays(const std::string& path) {
+    ReplayReader reader(path);
+    std::vector<Replay> out;
+    Replay replay;
+    while (reader.next(replay)) out.push_back(replay);
+    return out;
+}
+
+}  // namespace pkmn
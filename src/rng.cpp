@@ -0,0 +1,43 @@
+#include "rng.hpp"
+
+namespace pkmn {
+
+static const char* const RNG_TAG_NAMES[RNG_TAG_COUNT] = {
+    "other", "speed_tie", "accuracy", "crit", "damage_roll", "ai_script", "ai_tie_break", "policy",
+};
+
+const char* rngTagName(RngTag tag) {
+    return RNG_TAG_NAMES[static_cast<int>(tag)];
+}
+
+void counterRandomBatch(const uint64_t* keys, const uint64_t* counters, uint16_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) out[i] = counterRandom(keys[i], counters[i]);
+}
+
+bool rngTraceEnabled() {
+#ifdef PKMN_RNG_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef PKMN_RNG_TRACE
+
+static thread_local std::vector<RngDraw>* t_rngTrace = nullptr;
+
+void setRngTrace(std::vector<RngDraw>* out) {
+    t_rngTrace = out;
+}
+
+void rngTraceRecord(RngTag tag, uint16_t turn, uint16_t value) {
+    if (t_rngTrace) t_rngTrace->push_back(RngDraw{turn, value, tag});
+}
+
+#else
+
+void setRngTrace(std::vector<RngDraw>*) {}
+
+#endif
+
+}  // namespace pkmn
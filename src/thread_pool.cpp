@@ -0,0 +1,109 @@
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace pkmn {
+
+size_t ThreadPool::resolveThreadCount(size_t requested) {
+    if (requested > 0) return requested;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+ThreadPool::ThreadPool(size_t numThreads) {
+    size_t total = resolveThreadCount(numThreads);
+    m_workers.reserve(total - 1);
+    for (size_t i = 1; i < total; i++) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& t : m_workers) t.join();
+}
+
+void ThreadPool::runChunks(size_t workerIndex) {
+    try {
+        for (;;) {
+            size_t begin = m_next.fetch_add(m_grain, std::memory_order_relaxed);
+            if (begin >= m_count) break;
+            size_t end = std::min(m_count, begin + m_grain);
+            PKMN_TRACE_SCOPE(TraceEvent::WorkerShard, begin, end);
+            (*m_fn)(begin, end, workerIndex);
+        }
+    } catch (...) {
+        // Hand out no more chunks; parallelFor rethrows the first error once
+        // every thread is done with fn
+        m_next.store(m_count, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_error) m_error = std::current_exception();
+    }
+}
+
+void ThreadPool::workerLoop(size_t workerIndex) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) return;
+            seen = m_generation;
+        }
+
+        runChunks(workerIndex);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_pending == 0) m_done.notify_one();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const RangeFn& fn) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+
+    // Not worth waking anyone for a single chunk
+    if (m_workers.empty() || count <= grain) {
+        PKMN_TRACE_SCOPE(TraceEvent::WorkerShard, 0, count);
+        fn(0, count, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fn = &fn;
+        m_count = count;
+        m_grain = grain;
+        m_next.store(0, std::memory_order_relaxed);
+        m_pending = m_workers.size();
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    runChunks(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [&] { return m_pending == 0; });
+    m_fn = nullptr;
+    if (m_error) std::rethrow_exception(std::exchange(m_error, nullptr));
+}
+
+void parallelFor(size_t count, size_t numThreads, size_t grain, const ThreadPool::RangeFn& fn) {
+    // Don't spawn more threads than there are chunks
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (count + grain - 1) / grain;
+    size_t threads = std::min(ThreadPool::resolveThreadCount(numThreads), std::max<size_t>(chunks, 1));
+    if (threads <= 1) {
+        if (count > 0) fn(0, count, 0);
+        return;
+    }
+    ThreadPool pool(threads);
+    pool.parallelFor(count, grain, fn);
+}
+
+}  // namespace pkmn
@@ -0,0 +1,180 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace pkmn {
+
+static const char* const TRACE_EVENT_NAMES[TRACE_EVENT_KINDS] = {
+    "turn", "turn_order", "ai_decision", "execute_move", "damage", "end_of_turn",
+    "ai_script", "worker_shard", "env_step",
+};
+
+bool traceEventsEnabled() {
+#ifdef PKMN_TRACE_EVENTS
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef PKMN_TRACE_EVENTS
+
+namespace {
+
+// Threads beyond this record nothing
+constexpr int TRACE_MAX_THREADS = 256;
+constexpr size_t TRACE_MASK = TRACE_BUFFER_EVENTS - 1;
+static_assert((TRACE_BUFFER_EVENTS & TRACE_MASK) == 0, "TRACE_BUFFER_EVENTS must be a power of two");
+
+struct RawEvent {
+    uint64_t start;
+    uint64_t end;
+    uint32_t arg0;
+    uint32_t arg1;
+    TraceEvent kind;
+};
+
+struct TraceBuffer {
+    std::atomic<RawEvent*> events{nullptr};  // Allocated by the first owner, kept for reuse
+    std::atomic<uint64_t> written{0};        // Events ever appended; the ring holds the last few
+    std::atomic<bool> inUse{false};
+
+    ~TraceBuffer() { delete[] events.load(std::memory_order_relaxed); }
+};
+
+TraceBuffer g_buffers[TRACE_MAX_THREADS];
+std::atomic<bool> g_running{false};
+std::atomic<uint64_t> g_startTicks{0};
+
+struct ThreadSlot {
+    TraceBuffer* buffer = nullptr;
+    bool full = false;  // Every buffer was taken
+
+    TraceBuffer* acquire() {
+        for (TraceBuffer& candidate : g_buffers) {
+            bool expected = false;
+            if (!candidate.inUse.load(std::memory_order_relaxed) &&
+                candidate.inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                if (!candidate.events.load(std::memory_order_relaxed)) {
+                    candidate.events.store(new RawEvent[TRACE_BUFFER_EVENTS], std::memory_order_release);
+                }
+                return buffer = &candidate;
+            }
+        }
+        full = true;
+        return nullptr;
+    }
+
+    ~ThreadSlot() {
+        if (buffer) buffer->inUse.store(false, std::memory_order_release);
+    }
+};
+
+thread_local ThreadSlot t_slot;
+
+void writeArgs(std::ostream& os, const RawEvent& e) {
+    switch (e.kind) {
+        case TraceEvent::AIScript:
+            os << ",\"args\":{\"script\":" << e.arg0 << ",\"move_slot\":" << e.arg1 << "}";
+            break;
+        case TraceEvent::WorkerShard:
+            os << ",\"args\":{\"begin\":" << e.arg0 << ",\"end\":" << e.arg1 << "}";
+            break;
+        case TraceEvent::EnvStep:
+            os << ",\"args\":{\"env\":" << e.arg0 << "}";
+            break;
+        default:
+            break;
+    }
+}
+
+}  // namespace
+
+void traceRecord(TraceEvent event, uint64_t startTicks, uint64_t endTicks, uint32_t arg0, uint32_t arg1) {
+    if (!g_running.load(std::memory_order_relaxed)) return;
+    TraceBuffer* buffer = t_slot.buffer;
+    if (!buffer) {
+        if (t_slot.full || !(buffer = t_slot.acquire())) return;
+    }
+    RawEvent* events = buffer->events.load(std::memory_order_relaxed);
+    const uint64_t n = buffer->written.load(std::memory_order_relaxed);
+    events[n & TRACE_MASK] = RawEvent{startTicks, endTicks, arg0, arg1, event};
+    buffer->written.store(n + 1, std::memory_order_release);
+}
+
+void traceRecordPhase(PerfPhase phase, uint64_t startTicks, uint64_t endTicks) {
+    traceRecord(static_cast<TraceEvent>(phase), startTicks, endTicks, 0, 0);
+}
+
+void startTrace() {
+    g_running.store(false, std::memory_order_relaxed);
+    for (TraceBuffer& buffer : g_buffers) buffer.written.store(0, std::memory_order_relaxed);
+    perfTicksPerSecond();  // Calibrate now rather than inside the first write
+    g_startTicks.store(perfTicks(), std::memory_order_relaxed);
+    g_running.store(true, std::memory_order_release);
+}
+
+void stopTrace() {
+    g_running.store(false, std::memory_order_release);
+}
+
+bool traceRunning() {
+    return g_running.load(std::memory_order_relaxed);
+}
+
+size_t writeChromeTrace(const std::string& path) {
+    std::ofstream os(path);
+    if (!os) throw std::runtime_error("Cannot open trace file: " + path);
+
+    const uint64_t origin = g_startTicks.load(std::memory_order_relaxed);
+    const double usPerTick = 1e6 / perfTicksPerSecond();
+    size_t count = 0;
+    bool first = true;
+    os << std::fixed << std::setprecision(3);
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (int tid = 0; tid < TRACE_MAX_THREADS; tid++) {
+        const TraceBuffer& buffer = g_buffers[tid];
+        const RawEvent* events = buffer.events.load(std::memory_order_acquire);
+        const uint64_t written = buffer.written.load(std::memory_order_acquire);
+        if (!events || written == 0) continue;
+
+        os << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+           << ",\"args\":{\"name\":\"thread " << tid << "\"}}";
+        first = false;
+        for (uint64_t i = written - std::min<uint64_t>(written, TRACE_BUFFER_EVENTS); i < written; i++) {
+            const RawEvent& e = events[i & TRACE_MASK];
+            if (e.start < origin) continue;  // Left over from before startTrace
+            os << ",\n{\"name\":\"" << TRACE_EVENT_NAMES[static_cast<int>(e.kind)]
+               << "\",\"cat\":\"engine\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+               << ",\"ts\":" << (e.start - origin) * usPerTick << ",\"dur\":" << (e.end - e.start) * usPerTick;
+            writeArgs(os, e);
+            os << "}";
+            count++;
+        }
+    }
+    os << "\n]}\n";
+    if (!os) throw std::runtime_error("Failed to write trace file: " + path);
+    return count;
+}
+
+#else
+
+void startTrace() {}
+
+void stopTrace() {}
+
+bool traceRunning() { return false; }
+
+size_t writeChromeTrace(const std::string& path) {
+    std::ofstream os(path);
+    if (!os) throw std::runtime_error("Cannot open trace file: " + path);
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[]}\n";
+    return 0;
+}
+
+#endif
+
+}  // namespace pkmn
@@ -0,0 +1,377 @@
+#include "trajectory.hpp"
+#include "observation.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pkmn {
+
+static const TrajectoryColumnInfo TRAJECTORY_COLUMN_INFO[TRAJECTORY_COLUMNS] = {
+    {"obs", "<f4", OBS_SIZE, OBS_SIZE * sizeof(float)},
+    {"action_mask", "|u1", NUM_ACTION_TYPES, NUM_ACTION_TYPES},
+    {"action", "|u1", 1, 1},
+    {"reward", "<f4", 1, sizeof(float)},
+    {"done", "|b1", 1, sizeof(bool)},
+    {"ai_scores", "|i1", 4, 4},
+    {"env", "<u4", 1, sizeof(uint32_t)},
+};
+
+// Touched one byte per page when a shard is prepared, so the writer doesn't
+// take the page faults
+static constexpr size_t PREFAULT_STRIDE = 4096;
+
+const TrajectoryColumnInfo& trajectoryColumnInfo(TrajectoryColumn column) {
+    return TRAJECTORY_COLUMN_INFO[static_cast<int>(column)];
+}
+
+static std::string columnPath(const std::string& dir, int column, size_t shard) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s.%06zu.bin", TRAJECTORY_COLUMN_INFO[column].name, shard);
+    return (std::filesystem::path(dir) / name).string();
+}
+
+// ============================================================================
+// Mapping
+// ============================================================================
+
+namespace {
+
+/// A file created at a fixed size and mapped read-write
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { unmap(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    void open(const std::string& path, size_t bytes) {
+        m_path = path;
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                                  CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot create trajectory file: " + path);
+        m_file = file;
+        LARGE_INTEGER size;
+        size.QuadPart = static_cast<LONGLONG>(bytes);
+        if (!SetFilePointerEx(file, size, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+            unmap();
+            throw std::runtime_error("Cannot size trajectory file: " + path);
+        }
+        m_mapHandle = CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+        if (m_mapHandle) m_data = static_cast<uint8_t*>(MapViewOfFile(m_mapHandle, FILE_MAP_WRITE, 0, 0, 0));
+#else
+        m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (m_fd < 0) throw std::runtime_error("Cannot create trajectory file: " + path);
+        if (ftruncate(m_fd, static_cast<off_t>(bytes)) != 0) {
+            unmap();
+            throw std::runtime_error("Cannot size trajectory file: " + path);
+        }
+        void* addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        m_data = (addr == MAP_FAILED) ? nullptr : static_cast<uint8_t*>(addr);
+#endif
+        m_size = bytes;
+        if (!m_data) {
+            unmap();
+            throw std::runtime_error("Cannot map trajectory file: " + path);
+        }
+        for (size_t offset = 0; offset < bytes; offset += PREFAULT_STRIDE) m_data[offset] = 0;
+    }
+
+    uint8_t* data() const { return m_data; }
+
+    /// Write back, unmap and trim the file to its first `usedBytes`
+    void finish(size_t usedBytes) {
+        bool ok = true;
+#ifdef _WIN32
+        ok = FlushViewOfFile(m_data, 0) != 0;
+        unmapView();
+        LARGE_INTEGER size;
+        size.QuadPart = static_cast<LONGLONG>(usedBytes);
+        ok = ok && SetFilePointerEx(m_file, size, nullptr, FILE_BEGIN) && SetEndOfFile(m_file) &&
+             FlushFileBuffers(m_file);
+#else
+        ok = msync(m_data, m_size, MS_SYNC) == 0;
+        unmapView();
+        ok = ok && ftruncate(m_fd, static_cast<off_t>(usedBytes)) == 0;
+        // Rows written to a file that was since removed or replaced are lost
+        struct stat opened, named;
+        ok = ok && fstat(m_fd, &opened) == 0 && ::stat(m_path.c_str(), &named) == 0 &&
+             opened.st_dev == named.st_dev && opened.st_ino == named.st_ino;
+#endif
+        unmap();
+        if (!ok) throw std::runtime_error("Failed writing trajectory file: " + m_path);
+    }
+
+    /// Unmap and delete the file
+    void discard() {
+        unmap();
+        std::error_code ignored;
+        std::filesystem::remove(m_path, ignored);
+    }
+
+private:
+    void unmapView() {
+#ifdef _WIN32
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapHandle) CloseHandle(m_mapHandle);
+        m_mapHandle = nullptr;
+#else
+        if (m_data) munmap(m_data, m_size);
+#endif
+        m_data = nullptr;
+    }
+
+    void unmap() {
+        unmapView();
+#ifdef _WIN32
+        if (m_file) CloseHandle(m_file);
+        m_file = nullptr;
+#else
+        if (m_fd >= 0) ::close(m_fd);
+        m_fd = -1;
+#endif
+    }
+
+    std::string m_path;
+    uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    HANDLE m_file = nullptr;
+    HANDLE m_mapHandle = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+}  // namespace
+
+struct TrajectoryRecorder::Shard {
+    size_t rows = 0;
+    MappedFile files[TRAJECTORY_COLUMNS];
+    bool used[TRAJECTORY_COLUMNS] = {};
+
+    void finish() {
+        for (int c = 0; c < TRAJECTORY_COLUMNS; c++) {
+            if (used[c]) files[c].finish(rows * TRAJECTORY_COLUMN_INFO[c].rowBytes);
+        }
+    }
+
+    void discard() {
+        for (int c = 0; c < TRAJECTORY_COLUMNS; c++) {
+            if (used[c]) files[c].discard();
+        }
+    }
+};
+
+// ============================================================================
+// Recorder
+// ============================================================================
+
+TrajectoryRecorder::TrajectoryRecorder(const std::string& dir, size_t rowsPerShard, bool aiScores)
+    : m_dir(dir), m_rowsPerShard(rowsPerShard), m_aiScores(aiScores) {
+    if (rowsPerShard == 0) throw std::runtime_error("rowsPerShard must be positive");
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) throw std::runtime_error("Cannot create trajectory directory: " + dir);
+
+    writeManifest({});  // Hide any previous recording in this directory
+    m_current = openShard(0);
+    m_nextIndex = 1;
+    m_flusher = std::thread(&TrajectoryRecorder::flusherLoop, this);
+}
+
+TrajectoryRecorder::~TrajectoryRecorder() {
+    try {
+        close();
+    } catch (const std::exception&) {
+        // Destructors can't report IO errors; call close() to see them
+    }
+}
+
+std::unique_ptr<TrajectoryRecorder::Shard> TrajectoryRecorder::openShard(size_t index) const {
+    auto shard = std::make_unique<Shard>();
+    try {
+        for (int c = 0; c < TRAJECTORY_COLUMNS; c++) {
+            if (c == static_cast<int>(TrajectoryColumn::AIScores) && !m_aiScores) continue;
+            shard->used[c] = true;
+            shard->files[c].open(columnPath(m_dir, c, index), m_rowsPerShard * TRAJECTORY_COLUMN_INFO[c].rowBytes);
+        }
+    } catch (...) {
+        shard->discard();
+        throw;
+    }
+    return shard;
+}
+
+void TrajectoryRecorder::flusherLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [&] { return m_stop || !m_retiring.empty() || (!m_next && !m_error); });
+
+        if (!m_retiring.empty()) {
+            std::unique_ptr<Shard> shard = std::move(m_retiring.front());
+            m_retiring.pop_front();
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                shard->finish();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+            if (error) {
+                if (!m_error) m_error = error;
+            } else if (!m_error) {
+                // The manifest maps entry i to shard i, so nothing after a
+                // failed shard can be listed
+                m_finished.push_back(shard->rows);
+                std::vector<uint64_t> finished = m_finished;
+                lock.unlock();
+                try {
+                    writeManifest(finished);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                lock.lock();
+                if (error && !m_error) m_error = error;
+            }
+            m_ready.notify_all();
+            continue;
+        }
+        if (m_stop) break;
+
+        const size_t index = m_nextIndex++;
+        lock.unlock();
+        std::unique_ptr<Shard> shard;
+        std::exception_ptr error;
+        try {
+            shard = openShard(index);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+        if (error) m_error = error;
+        else m_next = std::move(shard);
+        m_ready.notify_all();
+    }
+}
+
+TrajectoryRows TrajectoryRecorder::reserve(size_t count) {
+    if (m_closed) throw std::runtime_error("Trajectory recorder already closed: " + m_dir);
+    if (count > m_rowsPerShard) throw std::runtime_error("Cannot reserve more rows than rowsPerShard");
+
+    if (m_current->rows + count > m_rowsPerShard) {
+        // Swap only once the next shard is ready: after a flusher error the
+        // current shard stays in place and every later rotation rethrows
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_ready.wait(lock, [&] { return m_next || m_error; });
+        if (m_error) std::rethrow_exception(m_error);
+        m_retiring.push_back(std::move(m_current));
+        m_current = std::move(m_next);
+        m_wake.notify_all();  // Retire the old shard and prepare the one after
+    }
+
+    Shard& shard = *m_current;
+    const size_t row = shard.rows;
+    auto column = [&](TrajectoryColumn c) -> uint8_t* {
+        const int i = static_cast<int>(c);
+        return shard.used[i] ? shard.files[i].data() + row * TRAJECTORY_COLUMN_INFO[i].rowBytes : nullptr;
+    };
+    TrajectoryRows rows;
+    rows.obs = reinterpret_cast<float*>(column(TrajectoryColumn::Obs));
+    rows.masks = column(TrajectoryColumn::ActionMask);
+    rows.actions = column(TrajectoryColumn::Action);
+    rows.rewards = reinterpret_cast<float*>(column(TrajectoryColumn::Reward));
+    rows.dones = reinterpret_cast<bool*>(column(TrajectoryColumn::Done));
+    rows.aiScores = reinterpret_cast<int8_t*>(column(TrajectoryColumn::AIScores));
+    rows.envs = reinterpret_cast<uint32_t*>(column(TrajectoryColumn::Env));
+    rows.count = count;
+
+    shard.rows += count;
+    m_rows += count;
+    return rows;
+}
+
+size_t TrajectoryRecorder::shardRowsLeft() const {
+    return m_current ? m_rowsPerShard - m_current->rows : 0;
+}
+
+void TrajectoryRecorder::recordStep(VecBattleEnv& env, const Action* actions, float* rewards, bool* dones,
+                                    size_t count) {
+    const size_t n = std::min(env.size(), count);
+    TrajectoryRows rows = reserve(n);
+    env.observe(rows.obs, rows.masks, rows.aiScores, n);
+    for (size_t i = 0; i < n; i++) {
+        rows.actions[i] = static_cast<uint8_t>(actions[i].type);
+        rows.envs[i] = static_cast<uint32_t>(i);
+    }
+    env.step(actions, rows.rewards, rows.dones, n);
+    if (rewards) std::memcpy(rewards, rows.rewards, n * sizeof(float));
+    if (dones) std::memcpy(dones, rows.dones, n * sizeof(bool));
+}
+
+void TrajectoryRecorder::close() {
+    if (m_closed) return;
+    m_closed = true;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_current && m_current->rows > 0) m_retiring.push_back(std::move(m_current));
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    m_flusher.join();
+
+    if (m_current) m_current->discard();
+    if (m_next) m_next->discard();
+    m_current.reset();
+    m_next.reset();
+    if (m_error) std::rethrow_exception(m_error);
+    writeManifest(m_finished);
+}
+
+void TrajectoryRecorder::writeManifest(const std::vector<uint64_t>& shardRows) const {
+    const std::filesystem::path path = std::filesystem::path(m_dir) / "manifest.json";
+    const std::filesystem::path tmp = std::filesystem::path(m_dir) / "manifest.json.tmp";
+    {
+        std::ofstream os(tmp);
+        if (!os) throw std::runtime_error("Cannot write trajectory manifest: " + tmp.string());
+        os << "{\n  \"version\": " << TRAJECTORY_VERSION << ",\n  \"rows_per_shard\": " << m_rowsPerShard
+           << ",\n  \"columns\": [";
+        bool first = true;
+        for (int c = 0; c < TRAJECTORY_COLUMNS; c++) {
+            if (c == static_cast<int>(TrajectoryColumn::AIScores) && !m_aiScores) continue;
+            const TrajectoryColumnInfo& info = TRAJECTORY_COLUMN_INFO[c];
+            os << (first ? "" : ",") << "\n    {\"name\": \"" << info.name << "\", \"dtype\": \"" << info.dtype
+               << "\", \"shape\": [";
+            if (info.width > 1) os << info.width;
+            os << "]}";
+            first = false;
+        }
+        os << "\n  ],\n  \"shards\": [";
+        for (size_t i = 0; i < shardRows.size(); i++) os << (i ? ", " : "") << shardRows[i];
+        os << "]\n}\n";
+        if (!os) throw std::runtime_error("Cannot write trajectory manifest: " + tmp.string());
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) throw std::runtime_error("Cannot write trajectory manifest: " + path.string());
+}
+
+}  // namespace pkmn
@@ -0,0 +1,130 @@
+#include "transposition.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace pkmn {
+
+// Data word layout
+static constexpr int VALUE_BITS = 24;
+static constexpr int VISITS_SHIFT = 24;   // 20 bits
+static constexpr int DEPTH_SHIFT = 44;    // 8 bits
+static constexpr int BOUND_SHIFT = 52;    // 2 bits
+static constexpr int ACTION_SHIFT = 54;   // 4 bits
+static constexpr int GEN_SHIFT = 58;      // 6 bits
+static constexpr uint64_t VALUE_MAX = (1u << VALUE_BITS) - 1;
+
+// Buckets hashfull() looks at
+static constexpr size_t HASHFULL_SAMPLE_BUCKETS = 250;
+
+static uint64_t pack(const TTEntry& entry, uint8_t generation) {
+    uint64_t value = static_cast<uint64_t>(std::lround(std::clamp(entry.value, 0.0f, 1.0f) * VALUE_MAX));
+    return value | uint64_t(std::min(entry.visits, TT_MAX_VISITS)) << VISITS_SHIFT |
+           uint64_t(entry.depth) << DEPTH_SHIFT | uint64_t(entry.bound) << BOUND_SHIFT |
+           uint64_t(entry.bestAction & 0xF) << ACTION_SHIFT | uint64_t(generation) << GEN_SHIFT;
+}
+
+static TTEntry unpack(uint64_t data) {
+    TTEntry entry;
+    entry.value = static_cast<float>(data & VALUE_MAX) / VALUE_MAX;
+    entry.visits = static_cast<uint32_t>(data >> VISITS_SHIFT) & TT_MAX_VISITS;
+    entry.depth = static_cast<uint8_t>(data >> DEPTH_SHIFT);
+    entry.bound = static_cast<Bound>((data >> BOUND_SHIFT) & 0x3);
+    entry.bestAction = static_cast<uint8_t>((data >> ACTION_SHIFT) & 0xF);
+    return entry;
+}
+
+static uint8_t generationOf(uint64_t data) {
+    return static_cast<uint8_t>(data >> GEN_SHIFT);
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes) {
+    size_t buckets = std::max<size_t>(megabytes * 1024 * 1024 / sizeof(Bucket), 1);
+    size_t pow2 = 1;
+    while (pow2 * 2 <= buckets) pow2 *= 2;
+    m_buckets.reset(new Bucket[pow2]);
+    m_mask = pow2 - 1;
+    clear();
+}
+
+TranspositionTable::~TranspositionTable() = default;
+
+// An empty slot is all zeros; stored data never is (the action field of an
+// entry without one is TT_NO_ACTION)
+bool TranspositionTable::probe(uint64_t key, TTEntry& out) const {
+    const Bucket& bucket = m_buckets[key & m_mask];
+    for (int i = 0; i < ENTRIES_PER_BUCKET; i++) {
+        uint64_t data = bucket.data[i].load(std::memory_order_relaxed);
+        uint64_t check = bucket.check[i].load(std::memory_order_relaxed);
+        if (data != 0 && (check ^ data) == key) {
+            out = unpack(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, const TTEntry& entry) {
+    Bucket& bucket = m_buckets[key & m_mask];
+    const uint8_t generation = this->generation();
+
+    // Same key first, then empty, then the shallowest after aging
+    int victim = 0;
+    int victimScore = INT32_MAX;
+    for (int i = 0; i < ENTRIES_PER_BUCKET; i++) {
+        uint64_t data = bucket.data[i].load(std::memory_order_relaxed);
+        uint64_t check = bucket.check[i].load(std::memory_order_relaxed);
+        if (data == 0 || (check ^ data) == key) {
+            victim = i;
+            break;
+        }
+        int age = (generation - generationOf(data) + TT_GENERATIONS) % TT_GENERATIONS;
+        int score = static_cast<int>((data >> DEPTH_SHIFT) & 0xFF) - 8 * age;
+        if (score < victimScore) {
+            victimScore = score;
+            victim = i;
+        }
+    }
+
+    uint64_t data = pack(entry, generation);
+    bucket.data[victim].store(data, std::memory_order_relaxed);
+    bucket.check[victim].store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::newGeneration() {
+    uint8_t next = static_cast<uint8_t>((generation() + 1) % TT_GENERATIONS);
+    m_generation.store(next, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    for (size_t b = 0; b <= m_mask; b++) {
+        for (int i = 0; i < ENTRIES_PER_BUCKET; i++) {
+            m_buckets[b].check[i].store(0, std::memory_order_relaxed);
+            m_buckets[b].data[i].store(0, std::memory_order_relaxed);
+        }
+    }
+    m_generation.store(0, std::memory_order_relaxed);
+}
+
+// Entries of the first `buckets` buckets written this generation
+size_t TranspositionTable::countCurrent(size_t buckets) const {
+    const uint8_t generation = this->generation();
+    size_t used = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        for (int i = 0; i < ENTRIES_PER_BUCKET; i++) {
+            uint64_t data = m_buckets[b].data[i].load(std::memory_order_relaxed);
+            if (data != 0 && generationOf(data) == generation) used++;
+        }
+    }
+    return used;
+}
+
+int TranspositionTable::hashfull() const {
+    const size_t buckets = std::min(HASHFULL_SAMPLE_BUCKETS, m_mask + 1);
+    return static_cast<int>(countCurrent(buckets) * 1000 / (buckets * ENTRIES_PER_BUCKET));
+}
+
+size_t TranspositionTable::countUsed() const {
+    return countCurrent(m_mask + 1);
+}
+
+}  // namespace pkmn
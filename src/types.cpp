@@ -46,6 +46,18 @@ uint8_t BattleState::countRemaining(uint8_t side) const {
     return count;
 }
 
+int BattleState::teamHP(uint8_t side) const {
+    int hp = 0;
+    for (uint8_t i = 0; i < teamSizes[side]; i++) hp += teams[side][i].currentHP;
+    return hp;
+}
+
+int BattleState::teamMaxHP(uint8_t side) const {
+    int hp = 0;
+    for (uint8_t i = 0; i < teamSizes[side]; i++) hp += teams[side][i].maxHP;
+    return hp;
+}
+
 bool BattleState::isTerminal() const {
     return countRemaining(0) == 0 || countRemaining(1) == 0;
 }
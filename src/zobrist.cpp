@@ -0,0 +1,107 @@
+#include "zobrist.hpp"
+#include "rng.hpp"
+#include <algorithm>
+
+namespace pkmn {
+
+namespace {
+
+// Keys are a fixed splitMix64 stream built at compile time, so hashes are
+// stable across builds, runs and platforms
+constexpr uint64_t ZOBRIST_SEED = 0x2C1B3C6D5E7F8091ull;
+
+constexpr ZobristTables makeTables() {
+    ZobristTables t{};
+    uint64_t counter = ZOBRIST_SEED;
+    auto next = [&counter]() { return splitMix64(counter++); };
+
+    for (int side = 0; side < 2; side++) {
+        for (int slot = 0; slot < MAX_PARTY_SIZE; slot++) {
+            for (int i = 0; i < 256; i++) t.hpLow[side][slot][i] = next();
+            for (int i = 0; i < 256; i++) t.hpHigh[side][slot][i] = next();
+            for (int m = 0; m < MAX_MOVES; m++)
+                for (int i = 0; i <= ZOBRIST_MAX_PP; i++) t.pp[side][slot][m][i] = next();
+            for (int i = 0; i < ZOBRIST_STATUS_KEYS; i++) t.status[side][slot][i] = next();
+            t.partyIndex[side][slot] = next();
+        }
+        for (int s = 0; s < BATTLE_STAT_COUNT; s++)
+            for (int i = 0; i < ZOBRIST_STAGE_KEYS; i++) t.stages[side][s][i] = next();
+    }
+    for (int i = 0; i < 256; i++) t.turnLow[i] = next();
+    for (int i = 0; i < 256; i++) t.turnHigh[i] = next();
+    return t;
+}
+
+// Tags keep the mixed components of different fields apart
+enum MixTag : uint64_t {
+    TAG_VOLATILES = 1, TAG_WEATHER = 3, TAG_SIDE = 4, TAG_TEAM_SIZE = 6, TAG_SLOT = 8, TAG_STATS = 20
+};
+
+inline uint64_t mix(uint64_t tag, uint64_t value) {
+    return splitMix64(value ^ (ZOBRIST_SEED * (tag + 1)));
+}
+
+}  // namespace
+
+constexpr ZobristTables ZOBRIST_TABLES = makeTables();
+
+uint64_t zobristMon(const Pokemon& mon, uint8_t side, uint8_t slot) {
+    uint64_t h = zobristHP(side, slot, mon.currentHP);
+    for (int m = 0; m < MAX_MOVES; m++) h ^= zobristPP(side, slot, m, mon.pp[m]);
+    return h ^ ZOBRIST_TABLES.status[side][slot][static_cast<uint8_t>(mon.status) & (ZOBRIST_STATUS_KEYS - 1)];
+}
+
+uint64_t zobristActive(const ActiveMon& active, uint8_t side) {
+    uint64_t h = ZOBRIST_TABLES.partyIndex[side][active.partyIndex];
+    for (int s = 0; s < BATTLE_STAT_COUNT; s++) {
+        h ^= ZOBRIST_TABLES.stages[side][s][std::clamp(active.statStages[s] + 6, 0, ZOBRIST_STAGE_KEYS - 1)];
+    }
+    // protectedThisTurn only lives within a turn, so it is left out
+    uint64_t volatiles = uint64_t(active.confusionTurns) | uint64_t(active.tauntTurns) << 8 |
+                         uint64_t(active.substituteHP) << 16 | uint64_t(active.protectUses) << 24 |
+                         uint64_t(active.isConfused) << 32 | uint64_t(active.isTaunted) << 33 |
+                         uint64_t(active.isSeeded) << 34 | uint64_t(active.hasSubstitute) << 35 |
+                         uint64_t(active.typesOverridden) << 36 | uint64_t(active.types[0]) << 40 |
+                         uint64_t(active.types[1]) << 48;
+    return h ^ mix(TAG_VOLATILES + side, volatiles);
+}
+
+uint64_t zobristField(const BattleState& state) {
+    uint64_t h = mix(TAG_WEATHER, uint64_t(state.weather) | uint64_t(state.weatherTurns) << 8);
+    for (int side = 0; side < 2; side++) {
+        const SideState& s = state.sides[side];
+        uint64_t packed = uint64_t(s.hasReflect) | uint64_t(s.reflectTurns) << 8 |
+                          uint64_t(s.hasLightScreen) << 16 | uint64_t(s.lightScreenTurns) << 24 |
+                          uint64_t(s.hasSpikes) << 32 | uint64_t(s.spikesLayers) << 36 |
+                          uint64_t(s.hasToxicSpikes) << 40 | uint64_t(s.toxicSpikesLayers) << 44 |
+                          uint64_t(s.hasStealthRock) << 48;
+        h ^= mix(TAG_SIDE + side, packed);
+    }
+    return h;
+}
+
+uint64_t zobristSide(const BattleState& state, uint8_t side) {
+    uint64_t h = mix(TAG_TEAM_SIZE + side, state.teamSizes[side]) ^ zobristActive(state.active[side], side);
+    for (uint8_t slot = 0; slot < state.teamSizes[side]; slot++) {
+        // Gen 3 species, item and move ids all fit in 9 bits
+        const Pokemon& mon = state.teams[side][slot];
+        uint64_t identity = uint64_t(mon.species & 0x1FF) | uint64_t(mon.heldItem & 0x1FF) << 9 |
+                            uint64_t(mon.level & 0x7F) << 18;
+        for (int m = 0; m < MAX_MOVES; m++) identity |= uint64_t(mon.moves[m] & 0x1FF) << (25 + 9 * m);
+        // Nature, EVs and IVs only show in the computed stats, and frontier
+        // sets (or one set at two challenges) can differ in nothing else
+        uint64_t stats = uint64_t(mon.stats[0]) | uint64_t(mon.stats[1]) << 16 | uint64_t(mon.stats[2]) << 32 |
+                         uint64_t(mon.stats[3]) << 48;
+        uint64_t rest = uint64_t(mon.stats[4]) | uint64_t(mon.stats[5]) << 16 | uint64_t(mon.ability) << 32;
+        const uint64_t index = side * MAX_PARTY_SIZE + slot;
+        h ^= mix(TAG_SLOT + index, identity) ^ mix(TAG_STATS + index, stats ^ splitMix64(rest)) ^
+             zobristMon(mon, side, slot);
+    }
+    return h;
+}
+
+uint64_t zobristHash(const BattleState& state) {
+    return zobristSide(state, 0) ^ zobristSide(state, 1) ^ zobristField(state) ^ zobristTurn(state.turnNumber);
+}
+
+}  // namespace pkmn
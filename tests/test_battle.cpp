@@ -1,8 +1,500 @@
-// Placeholder for full battle tests
+#include "ai.hpp"
 #include "battle_engine.hpp"
+#include "factory.hpp"
+#include "lookahead.hpp"
+#include "perf_counters.hpp"
+#include "policy.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include "zobrist.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Simple test runner
+#define ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "Test failed: " << msg << std::endl; \
+        std::exit(1); \
+    }
+
+using namespace pkmn;
+
+static void setupFactoryBattle(BattleEngine& engine, uint32_t seed) {
+    uint32_t genSeed = seed;
+    FactoryGenerator::RentalPool pool;
+    FactoryGenerator::generateRentalPool(genSeed, 0, false, pool);
+
+    Pokemon player[3], opponent[3];
+    for (int i = 0; i < 3; i++) {
+        player[i] = FactoryGenerator::createPokemon(pool[i], 50);
+        opponent[i] = FactoryGenerator::createPokemon(pool[i + 3], 50);
+    }
+    engine.reset(seed);
+    engine.setPlayerTeam(player, 3);
+    engine.setOpponentTeam(opponent, 3);
+}
+
+void test_full_battles_terminate() {
+    std::cout << "Testing 3v3 battles run to completion..." << std::endl;
+    int finished = 0;
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        BattleEngine engine;
+        setupFactoryBattle(engine, seed);
+        int winner = playOut(engine, PolicyKind::ScriptedAI, 500);
+        if (winner >= 0) finished++;
+
+        // A fainted active is always replaced while the side has mons left
+        const BattleState& state = engine.getState();
+        for (int side = 0; side < 2; side++) {
+            if (state.countRemaining(side) > 0) {
+                ASSERT(state.getActivePokemon(side).currentHP > 0, "Fainted active was not replaced");
+            }
+        }
+    }
+    ASSERT(finished == 20, "Every battle should finish within the turn cap");
+}
+
+void test_legal_actions() {
+    std::cout << "Testing legal actions for both sides..." << std::endl;
+    BattleEngine engine;
+    setupFactoryBattle(engine, 3);
+
+    Action actions[MAX_LEGAL_ACTIONS];
+    for (uint8_t side = 0; side < 2; side++) {
+        int count = engine.getLegalActions(side, actions);
+        ASSERT(count > 0 && count <= MAX_LEGAL_ACTIONS, "Legal action count out of range");
+        int switches = 0;
+        for (int i = 0; i < count; i++) switches += actions[i].isSwitch();
+        ASSERT(switches == 2, "Both benched mons should be switch targets");
+    }
+    ASSERT(engine.getLegalActions().size() == static_cast<size_t>(engine.getLegalActions(0, actions)),
+           "Vector and array legal actions disagree");
+}
+
+void test_policies() {
+    std::cout << "Testing policies..." << std::endl;
+    BattleEngine engine;
+    setupFactoryBattle(engine, 11);
+
+    Action legal[MAX_LEGAL_ACTIONS];
+    int count = engine.getLegalActions(0, legal);
+    for (PolicyKind kind : {PolicyKind::ScriptedAI, PolicyKind::Random, PolicyKind::MaxDamage}) {
+        Action a = choosePolicyAction(engine, 0, kind);
+        bool isLegal = false;
+        for (int i = 0; i < count; i++) isLegal |= legal[i].type == a.type;
+        ASSERT(isLegal, "Policy chose an illegal action");
+    }
+}
+
+void test_step_both() {
+    std::cout << "Testing two-sided stepping..." << std::endl;
+    BattleEngine scripted, manual;
+    setupFactoryBattle(scripted, 17);
+    setupFactoryBattle(manual, 17);
+
+    // stepBoth with the AI's own choice must reproduce step()
+    for (int turn = 0; turn < 50 && !scripted.isTerminal(); turn++) {
+        Action player = choosePolicyAction(scripted, 0, PolicyKind::MaxDamage);
+        Action opponent = chooseAIAction(manual, 1);
+        StepResult a = scripted.step(player);
+        StepResult b = manual.stepBoth(player, opponent);
+        ASSERT(a.done == b.done && a.winner == b.winner, "step and stepBoth diverged");
+        ASSERT(scripted.getState().rngState == manual.getState().rngState, "RNG streams diverged");
+    }
+
+    // Vectorized self-play with [N][2] actions
+    const size_t numEnvs = 8;
+    VecBattleEnv env(numEnvs, 2);
+    std::vector<uint32_t> seeds(numEnvs);
+    for (size_t i = 0; i < numEnvs; i++) seeds[i] = static_cast<uint32_t>(i + 1);
+    env.reset(seeds.data(), numEnvs);
+    std::vector<uint16_t> ids(numEnvs * 6);
+    for (size_t i = 0; i < ids.size(); i++) ids[i] = static_cast<uint16_t>(i * 7 % 300);
+    env.setTeamsFromIds(ids.data(), numEnvs, 50);
+
+    std::vector<Action> actions(numEnvs * 2, Action{ActionType::Move1});
+    std::vector<float> rewards(numEnvs);
+    std::unique_ptr<bool[]> dones(new bool[numEnvs]);
+    env.stepBoth(actions.data(), rewards.data(), dones.get(), numEnvs);
+    for (size_t i = 0; i < numEnvs; i++) {
+        ASSERT(env.getState(i).turnNumber == 1, "Every environment should advance one turn");
+    }
+}
+
+void test_opponent_policies() {
+    std::cout << "Testing pluggable opponent policies..." << std::endl;
+    for (PolicyKind kind : {PolicyKind::Random, PolicyKind::MaxDamage, PolicyKind::FixedIndex}) {
+        for (uint32_t seed = 1; seed <= 5; seed++) {
+            BattleEngine engine;
+            setupFactoryBattle(engine, seed);
+            engine.setOpponentPolicy(Policy(kind, 1));
+            int winner = playOut(engine, PolicyKind::MaxDamage, 200);
+            ASSERT(winner == 0 || winner == 1 || engine.getTurnCount() == 200, "Battle ended in a bad state");
+        }
+    }
+
+    // FixedIndex picks that slot of the legal list, clamped to the last one
+    BattleEngine viaPolicy, viaStepBoth;
+    setupFactoryBattle(viaPolicy, 4);
+    setupFactoryBattle(viaStepBoth, 4);
+    viaPolicy.setOpponentPolicy(Policy(PolicyKind::FixedIndex, 200));
+    viaPolicy.reset(4);
+    ASSERT(viaPolicy.getOpponentPolicy().kind == PolicyKind::FixedIndex, "Policy should survive reset");
+    setupFactoryBattle(viaPolicy, 4);
+
+    Action legal[MAX_LEGAL_ACTIONS];
+    int count = viaStepBoth.getLegalActions(1, legal);
+    Action player{ActionType::Move1};
+    viaPolicy.step(player);
+    viaStepBoth.stepBoth(player, legal[count - 1]);
+    ASSERT(viaPolicy.getState().rngState == viaStepBoth.getState().rngState &&
+           viaPolicy.getState().active[1].partyIndex == viaStepBoth.getState().active[1].partyIndex,
+           "FixedIndex should match stepping with the clamped legal action");
+}
+
+void test_zobrist_hash() {
+    std::cout << "Testing incremental Zobrist hash..." << std::endl;
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        BattleEngine engine;
+        setupFactoryBattle(engine, seed);
+        ASSERT(engine.getHash() == zobristHash(engine.getState()), "Setup hash mismatch");
+
+        // The turn is hashed, so no position repeats within a battle
+        std::set<uint64_t> seen{engine.getHash()};
+        while (!engine.isTerminal() && engine.getTurnCount() < 300) {
+            engine.stepBoth(choosePolicyAction(engine, 0, PolicyKind::Random),
+                            choosePolicyAction(engine, 1, PolicyKind::Random));
+            ASSERT(engine.getHash() == zobristHash(engine.getState()), "Incremental hash diverged");
+            ASSERT(seen.insert(engine.getHash()).second, "Hash repeated within a battle");
+        }
+    }
+
+    // The RNG isn't hashed: the same forced turn from two seeds transposes
+    BattleEngine a, b;
+    setupFactoryBattle(a, 5);
+    setupFactoryBattle(b, 5);
+    b.setRngState(999);
+    ASSERT(a.getHash() == b.getHash(), "RNG state must not affect the hash");
+    TurnOutcome outcome;
+    Action player{ActionType::Move1}, opponent{ActionType::Move1};
+    a.stepWithOutcome(player, opponent, outcome);
+    b.stepWithOutcome(player, opponent, outcome);
+    ASSERT(a.getHash() == b.getHash(), "Same forced turn should reach the same hash");
+
+    // Team edits keep the hash current and change it
+    uint64_t before = a.getHash();
+    Pokemon replacement = a.getState().teams[1][0];
+    a.setPartyMember(1, 2, replacement);
+    ASSERT(a.getHash() == zobristHash(a.getState()), "setPartyMember hash mismatch");
+    ASSERT(a.getHash() != before, "New party member should change the hash");
+
+    // Sets that differ only in nature, EVs or IVs differ only in stats
+    before = a.getHash();
+    replacement.stats[Stat::Speed]++;
+    a.setPartyMember(1, 2, replacement);
+    ASSERT(a.getHash() == zobristHash(a.getState()), "setPartyMember hash mismatch");
+    ASSERT(a.getHash() != before, "Different stats should change the hash");
+}
+
+void test_lookahead_all() {
+    std::cout << "Testing one-step lookahead over legal actions..." << std::endl;
+    BattleEngine engine;
+    setupFactoryBattle(engine, 6);
+    engine.setOpponentPolicy(Policy(PolicyKind::MaxDamage));
+
+    LookaheadConfig config;
+    config.seed = 17;
+    config.numThreads = 1;
+    LookaheadResult serial = lookaheadAll(engine, 64, config);
+    config.numThreads = 4;
+    LookaheadResult parallel = lookaheadAll(engine, 64, config);
+
+    Action legal[MAX_LEGAL_ACTIONS];
+    ASSERT(serial.count == engine.getLegalActions(0, legal), "One entry per legal action");
+    ASSERT(engine.getTurnCount() == 0, "Root must not be stepped");
+    for (int a = 0; a < serial.count; a++) {
+        ASSERT(serial.actions[a].type == legal[a].type, "Actions in getLegalActions order");
+        ASSERT(serial.winRate[a] + serial.lossRate[a] <= 1.0f, "Rates out of range");
+        ASSERT(serial.playerHPDelta[a] >= -1.0f && serial.opponentHPDelta[a] <= 0.0f, "HP deltas out of range");
+        ASSERT(serial.winRate[a] == parallel.winRate[a] && serial.playerHPDelta[a] == parallel.playerHPDelta[a] &&
+               serial.opponentHPDelta[a] == parallel.opponentHPDelta[a], "Thread count must not change results");
+    }
+
+    // A single sample is exactly a step from the derived seed
+    config.numThreads = 1;
+    LookaheadResult one = lookaheadAll(engine, 1, config);
+    for (int a = 0; a < one.count; a++) {
+        BattleEngine copy = engine;
+        copy.setRngState(deriveSeed(config.seed, 0, 0));
+        copy.step(one.actions[a]);
+        int before = 0, after = 0, maxHP = 0;
+        for (int i = 0; i < 3; i++) {
+            before += engine.getState().teams[1][i].currentHP;
+            after += copy.getState().teams[1][i].currentHP;
+            maxHP += engine.getState().teams[1][i].maxHP;
+        }
+        ASSERT(std::abs(one.opponentHPDelta[a] - float(after - before) / maxHP) < 1e-6f, "Sample mismatch");
+    }
+
+    // VecBattleEnv entry point on the env's own pool
+    VecBattleEnv env(2, 2);
+    setupFactoryBattle(engine, 6);
+    uint32_t seeds[2] = {6, 6};
+    env.reset(seeds, 2);
+    FactoryGenerator::RentalPool pool;
+    uint32_t genSeed = 6;
+    FactoryGenerator::generateRentalPool(genSeed, 0, false, pool);
+    Pokemon player[3], opponent[3];
+    for (int i = 0; i < 3; i++) {
+        player[i] = FactoryGenerator::createPokemon(pool[i], 50);
+        opponent[i] = FactoryGenerator::createPokemon(pool[i + 3], 50);
+    }
+    env.setPlayerTeam(1, player, 3);
+    env.setOpponentTeam(1, opponent, 3);
+    env.setOpponentPolicy(Policy(PolicyKind::MaxDamage));
+    LookaheadResult viaEnv = env.lookaheadAll(1, 64, 17);
+    for (int a = 0; a < serial.count; a++) {
+        ASSERT(viaEnv.winRate[a] == serial.winRate[a] && viaEnv.playerHPDelta[a] == serial.playerHPDelta[a],
+               "VecBattleEnv lookahead should match the free function");
+    }
+}
+
+void test_perf_counters() {
+    std::cout << "Testing hot-path phase counters..." << std::endl;
+    resetPerfCounters();
+    BattleEngine engine;
+    setupFactoryBattle(engine, 8);
+    playOut(engine, PolicyKind::ScriptedAI, 200);
+    const uint64_t turns = engine.getTurnCount();
+
+    // Threads that exit keep their counts
+    std::thread worker([] {
+        BattleEngine other;
+        setupFactoryBattle(other, 9);
+        other.stepBoth(Action{ActionType::Move1}, Action{ActionType::Move1});
+    });
+    worker.join();
+
+    PerfCounters counters = getPerfCounters();
+    if (!perfCountersEnabled()) {
+        for (const PerfCounter& c : counters.phases) ASSERT(c.calls == 0 && c.ticks == 0, "Disabled counters must stay zero");
+        return;
+    }
+    ASSERT(counters[PerfPhase::Turn].calls == turns + 1, "One Turn per executeTurn on any thread");
+    ASSERT(counters[PerfPhase::TurnOrder].calls == turns + 1, "One TurnOrder per turn");
+    ASSERT(counters[PerfPhase::AIDecision].calls >= 2 * turns, "Both sides decide every turn");
+    ASSERT(counters[PerfPhase::Turn].ticks >= counters[PerfPhase::EndOfTurn].ticks, "Phases nest inside Turn");
+    ASSERT(counters[PerfPhase::Turn].seconds > 0.0, "Ticks convert to seconds");
+
+    resetPerfCounters();
+    ASSERT(getPerfCounters()[PerfPhase::Turn].calls == 0, "Reset clears every thread's counters");
+}
+
+void test_chrome_trace() {
+    std::cout << "Testing Chrome trace export..." << std::endl;
+    VecBattleEnv env(8, 2);
+    std::vector<uint32_t> seeds(8);
+    std::vector<uint16_t> ids(8 * 6);
+    for (size_t i = 0; i < 8; i++) {
+        seeds[i] = static_cast<uint32_t>(i + 1);
+        for (int k = 0; k < 6; k++) ids[i * 6 + k] = static_cast<uint16_t>(i * 31 + k * 97);
+    }
+    env.reset(seeds.data(), 8);
+    env.setTeamsFromIds(ids.data(), 8, 50);
+
+    startTrace();
+    Action actions[8];
+    float rewards[8];
+    bool dones[8];
+    for (Action& a : actions) a.type = ActionType::Move1;
+    for (int turn = 0; turn < 3; turn++) env.step(actions, rewards, dones, 8);
+    stopTrace();
+
+    const char* path = "test_trace.json";
+    size_t events = writeChromeTrace(path);
+    std::ifstream file(path);
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::remove(path);
+    ASSERT(json.find("\"traceEvents\":[") != std::string::npos, "Not a Chrome trace");
+    if (!traceEventsEnabled()) {
+        ASSERT(events == 0 && !traceRunning(), "Tracing is compiled out");
+        return;
+    }
+    ASSERT(events >= 8 * 3 * 2, "Expected env_step and turn events for every step");
+    ASSERT(json.find("\"env_step\"") != std::string::npos && json.find("\"worker_shard\"") != std::string::npos &&
+           json.find("\"ai_script\"") != std::string::npos && json.find("\"turn\"") != std::string::npos,
+           "Missing event kinds");
+
+    // Nothing is recorded once stopped
+    env.step(actions, rewards, dones, 8);
+    ASSERT(writeChromeTrace(path) == events, "Events recorded after stopTrace");
+    std::remove(path);
+}
+
+void test_rng_jump() {
+    std::cout << "Testing LCG jump-ahead..." << std::endl;
+    BattleEngine engine;
+    engine.reset(12345);
+    BattleEngine jumped = engine;
+    for (int i = 0; i < 1000; i++) engine.random();
+    jumped.advanceRng(1000);
+    ASSERT(jumped.getState().rngState == engine.getState().rngState, "advanceRng should match stepping");
+    ASSERT(jumped.random() == engine.random(), "Draws after a jump should match");
+
+    uint32_t seed = 777, stepped = 777;
+    for (int i = 0; i < 321; i++) stepped = stepped * FACTORY_RNG_MULT + FACTORY_RNG_INC;
+    ASSERT(factoryRngJump(seed, 321) == stepped, "Factory jump should match stepping");
+    ASSERT(emeraldRngJump(seed, 0) == seed, "Zero jump is the identity");
+    ASSERT(emeraldRngJump(emeraldRngJump(seed, 5), (uint64_t(1) << 32) - 5) == seed, "Full period wraps around");
+    static_assert(emeraldRngJump(0, 1) == EMERALD_RNG_INC, "Jump is constexpr");
+}
+
+void test_rng_trace() {
+    std::cout << "Testing RNG draw trace..." << std::endl;
+    BattleEngine engine;
+    setupFactoryBattle(engine, 9);
+    std::vector<RngDraw> draws;
+    setRngTrace(&draws);
+    const uint32_t before = engine.getState().rngState;
+    int turns = 0;
+    while (!engine.isTerminal() && turns++ < 10) engine.step(Action{ActionType::Move1});
+    setRngTrace(nullptr);
+    engine.random();
+
+    if (!rngTraceEnabled()) {
+        ASSERT(draws.empty(), "RNG trace is compiled out");
+        return;
+    }
+    ASSERT(!draws.empty(), "Turns draw from the RNG");
+    // Every draw is recorded: replaying the LCG reproduces the values
+    uint32_t state = before;
+    std::set<RngTag> tags;
+    for (const RngDraw& d : draws) {
+        state = emeraldRngJump(state, 1);
+        ASSERT(d.value == state >> 16, "Trace should hold every draw in order");
+        tags.insert(d.tag);
+    }
+    ASSERT(draws.back().turn >= draws.front().turn, "Turns should be nondecreasing");
+    ASSERT(tags.count(RngTag::DamageRoll) && tags.count(RngTag::Crit) && tags.count(RngTag::Accuracy),
+           "Damage, crit and accuracy draws should be tagged");
+    ASSERT(tags.count(RngTag::Other) == 0, "Engine draws should all have call-site tags");
+}
+
+void test_counter_rng() {
+    std::cout << "Testing counter-based RNG mode..." << std::endl;
+    const uint64_t key = counterRngKey(42, 3, 7);
+    BattleEngine engine;
+    engine.reset(1);
+    engine.setRngMode(RngMode::Counter);
+    engine.seedCounterRng(key);
+    for (uint64_t i = 0; i < 100; i++) ASSERT(engine.random() == counterRandom(key, i), "Draw i is counterRandom(key, i)");
+    engine.advanceRng(900);
+    ASSERT(engine.getRngCounter() == 1000 && engine.random() == counterRandom(key, 1000), "Counter jump is O(1)");
+    ASSERT(engine.getState().rngState == 1, "Counter mode leaves the LCG state alone");
+
+    // Batch kernel matches the scalar draw
+    std::vector<uint64_t> keys(37), counters(37);
+    std::vector<uint16_t> out(37);
+    for (size_t i = 0; i < keys.size(); i++) {
+        keys[i] = counterRngKey(1, i, 0);
+        counters[i] = i * 13;
+    }
+    counterRandomBatch(keys.data(), counters.data(), out.data(), out.size());
+    for (size_t i = 0; i < out.size(); i++) ASSERT(out[i] == counterRandom(keys[i], counters[i]), "Batch mismatch");
+
+    // Each env's battle depends only on (global seed, env, episode), not on
+    // batch size or thread count
+    const size_t n = 6;
+    std::vector<uint32_t> seeds(n, 0);
+    std::vector<uint16_t> ids(n * 6);
+    std::vector<uint64_t> episodes(n);
+    for (size_t i = 0; i < n; i++) {
+        episodes[i] = i % 2;
+        for (int k = 0; k < 6; k++) ids[i * 6 + k] = static_cast<uint16_t>(i * 53 + k * 89);
+    }
+    auto runBatch = [&](size_t envs, size_t threads, std::vector<uint64_t>& hashes) {
+        VecBattleEnv env(envs, threads);
+        env.reset(seeds.data(), envs);
+        env.setTeamsFromIds(ids.data(), envs, 50);
+        env.setRngMode(RngMode::Counter);
+        env.seedCounterRngs(99, episodes.data(), envs);
+        std::vector<Action> actions(envs, Action{ActionType::Move1});
+        std::vector<float> rewards(envs);
+        std::unique_ptr<bool[]> dones(new bool[envs]);
+        for (int t = 0; t < 8; t++) env.step(actions.data(), rewards.data(), dones.get(), envs);
+        hashes.clear();
+        for (size_t i = 0; i < envs; i++) hashes.push_back(env.getState(i).hash);
+    };
+    std::vector<uint64_t> full, threaded, half;
+    runBatch(n, 1, full);
+    runBatch(n, 3, threaded);
+    runBatch(n / 2, 1, half);
+    ASSERT(full == threaded, "Thread count should not change counter streams");
+    for (size_t i = 0; i < n / 2; i++) ASSERT(full[i] == half[i], "Batch size should not change counter streams");
+
+    BattleEngine counter;
+    setupFactoryBattle(counter, 5);
+    counter.setRngMode(RngMode::Counter);
+    int turns = 0;
+    while (!counter.isTerminal() && turns++ < 200) counter.step(Action{ActionType::Move1});
+    ASSERT(counter.isTerminal(), "Battles should finish in counter mode");
+}
+
+void test_thread_pool_exceptions() {
+    std::cout << "Testing thread pool exceptions..." << std::endl;
+    ThreadPool pool(4);
+    for (size_t thrower : {size_t(0), size_t(37), size_t(999)}) {
+        std::atomic<size_t> done{0};
+        bool threw = false;
+        try {
+            pool.parallelFor(1000, 1, [&](size_t begin, size_t end, size_t) {
+                for (size_t i = begin; i < end; i++) {
+                    if (i == thrower) throw std::runtime_error("item failed");
+                    std::this_thread::sleep_for(std::chrono::microseconds(10));
+                    done++;
+                }
+            });
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        ASSERT(threw, "Exception from item " << thrower << " should reach the caller");
+        ASSERT(done.load() < 1000, "Chunks after the exception should be skipped");
+    }
+
+    // The pool stays usable
+    std::atomic<size_t> sum{0};
+    pool.parallelFor(1000, 8, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) sum += i;
+    });
+    ASSERT(sum.load() == 999 * 1000 / 2, "Pool should run normally after an exception");
+}
 
 int main() {
-    std::cout << "Battle tests placeholder\n";
+    test_full_battles_terminate();
+    test_legal_actions();
+    test_policies();
+    test_step_both();
+    test_opponent_policies();
+    test_zobrist_hash();
+    test_lookahead_all();
+    test_perf_counters();
+    test_chrome_trace();
+    test_rng_jump();
+    test_rng_trace();
+    test_counter_rng();
+    test_thread_pool_exceptions();
+    std::cout << "All battle tests passed!" << std::endl;
     return 0;
 }
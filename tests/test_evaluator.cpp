@@ -0,0 +1,170 @@
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include "evaluator.hpp"
+#include "factory.hpp"
+#include "rng.hpp"
+
+// Simple test runner
+#define ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "Test failed: " << msg << std::endl; \
+        std::exit(1); \
+    }
+
+using namespace pkmn;
+
+// Counts every heap allocation in the process, for the allocation-free checks
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+void test_rental_combos() {
+    std::cout << "Testing rental combo ordering..." << std::endl;
+    const auto& combos = getRentalCombos();
+    ASSERT(combos[0] == (RentalCombo{0, 1, 2}), "First combo should be (0, 1, 2)");
+    ASSERT(combos[1] == (RentalCombo{0, 1, 3}), "Second combo should be (0, 1, 3)");
+    ASSERT(combos[19] == (RentalCombo{3, 4, 5}), "Last combo should be (3, 4, 5)");
+}
+
+void test_wilson_interval() {
+    std::cout << "Testing Wilson interval..." << std::endl;
+    WinRateEstimate est = makeWinRateEstimate(50, 100);
+    ASSERT(est.winRate == 0.5f, "Point estimate mismatch");
+    ASSERT(est.ciLow > 0.39f && est.ciLow < 0.41f, "Lower bound mismatch");
+    ASSERT(est.ciHigh > 0.59f && est.ciHigh < 0.61f, "Upper bound mismatch");
+
+    est = makeWinRateEstimate(0, 10);
+    ASSERT(est.ciLow == 0.0f && est.ciHigh > 0.0f, "Zero-win interval should be one-sided");
+}
+
+void test_evaluate_rental_combos() {
+    std::cout << "Testing rental combo evaluation..." << std::endl;
+    uint32_t seed = 99;
+    FactoryGenerator::RentalPool pool;
+    FactoryGenerator::generateRentalPool(seed, 0, false, pool);
+
+    EvaluatorConfig config;
+    config.playerPolicy = PolicyKind::MaxDamage;
+    config.seed = 5;
+    config.numThreads = 2;
+    auto a = evaluateRentalCombos(pool.data(), 0, false, 16, config);
+
+    // Thread count must not change the result
+    config.numThreads = 1;
+    auto b = evaluateRentalCombos(pool.data(), 0, false, 16, config);
+
+    for (int c = 0; c < NUM_RENTAL_COMBOS; c++) {
+        ASSERT(a[c].samples == 16, "Sample count mismatch");
+        ASSERT(a[c].wins == b[c].wins, "Evaluation must be deterministic across thread counts");
+        ASSERT(a[c].ciLow <= a[c].winRate && a[c].winRate <= a[c].ciHigh, "Estimate outside its interval");
+    }
+}
+
+void test_evaluate_swaps() {
+    std::cout << "Testing swap evaluation..." << std::endl;
+    uint32_t seed = 123;
+    FactoryGenerator::RentalPool pool;
+    FactoryGenerator::generateRentalPool(seed, 1, true, pool);
+    const uint16_t team[3] = {pool[0], pool[1], pool[2]};
+    const uint16_t defeated[3] = {pool[3], pool[4], pool[5]};
+
+    EvaluatorConfig config;
+    config.playerPolicy = PolicyKind::MaxDamage;
+    config.seed = 9;
+    config.numThreads = 2;
+    auto swaps = evaluateSwaps(team, defeated, 1, 4, true, 8, config);
+    for (int o = 0; o < NUM_SWAP_OPTIONS; o++) {
+        ASSERT(swaps[o].survival.samples == 8, "Sample count mismatch");
+        ASSERT(swaps[o].meanBattlesWon >= 0.0f && swaps[o].meanBattlesWon <= 2.0f,
+               "Two battles remain after battle 4");
+        ASSERT(swaps[o].meanBattlesWon >= 2.0f * swaps[o].survival.winRate - 1e-5f,
+               "Survivors must win every remaining battle");
+    }
+
+    // Nothing left to play after the last battle
+    auto last = evaluateSwaps(team, defeated, 1, 6, true, 4, config);
+    for (int o = 0; o < NUM_SWAP_OPTIONS; o++) {
+        ASSERT(last[o].survival.winRate == 1.0f && last[o].meanBattlesWon == 0.0f,
+               "Challenge is already cleared");
+    }
+
+    // Out-of-range battle numbers would index past the per-battle arrays
+    for (int battleNum : {-5, -1, BATTLES_PER_CHALLENGE, 100}) {
+        bool threw = false;
+        try {
+            evaluateSwaps(team, defeated, 1, battleNum, true, 4, config);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        ASSERT(threw, "battleNum " << battleNum << " should be rejected");
+    }
+}
+
+void test_playouts() {
+    std::cout << "Testing batched playouts..." << std::endl;
+    uint32_t seed = 77;
+    FactoryGenerator::RentalPool pool;
+    FactoryGenerator::generateRentalPool(seed, 0, false, pool);
+    Pokemon player[3], opponent[3];
+    for (int i = 0; i < 3; i++) {
+        player[i] = FactoryGenerator::createPokemon(pool[i], 50);
+        opponent[i] = FactoryGenerator::createPokemon(pool[i + 3], 50);
+    }
+    BattleEngine engine;
+    engine.reset(5);
+    engine.setPlayerTeam(player, 3);
+    engine.setOpponentTeam(opponent, 3);
+    engine.setOpponentPolicy(Policy(PolicyKind::MaxDamage));
+
+    PlayoutStats serial = playouts(engine, 200, PolicyKind::Random, 200, 3, 1);
+    PlayoutStats parallel = playouts(engine, 200, PolicyKind::Random, 200, 3, 3);
+    ASSERT(serial.win.samples == 200 && serial.win.wins == parallel.win.wins &&
+           serial.meanTurns == parallel.meanTurns && serial.meanPlayerHP == parallel.meanPlayerHP,
+           "Thread count must not change results");
+    ASSERT(engine.getTurnCount() == 0, "Snapshot must not be played");
+    ASSERT(serial.meanTurns >= 3.0f, "A 3v3 needs at least three turns");
+    ASSERT(serial.meanPlayerHP >= 0.0f && serial.meanPlayerHP <= 1.0f, "HP fraction out of range");
+    ASSERT(serial.meanOpponentHP >= 0.0f && serial.meanOpponentHP <= 1.0f, "HP fraction out of range");
+
+    // Playout 0 is one playOut from the derived seed
+    BattleEngine copy = engine;
+    copy.setRngState(deriveSeed(3, 0, 0));
+    int winner = playOut(copy, PolicyKind::Random, 200);
+    PlayoutStats one = playouts(engine, 1, PolicyKind::Random, 200, 3, 1);
+    ASSERT(one.win.wins == (winner == 0 ? 1u : 0u) && one.meanTurns == copy.getTurnCount(), "Playout 0 mismatch");
+
+    // The turn cap counts from the snapshot
+    PlayoutStats capped = playouts(engine, 50, PolicyKind::Random, 1, 3, 2);
+    ASSERT(capped.capped == 50 && capped.meanTurns == 1.0f && capped.win.wins == 0, "Every playout stops after a turn");
+
+    // Allocation-free per playout, ScriptedAI opponent included: the only
+    // allocations are the per-call setup, however many battles are played
+    engine.setOpponentPolicy(Policy(PolicyKind::ScriptedAI));
+    playouts(engine, 1, PolicyKind::Random, 200, 3, 1);  // Warm up lazily built tables
+    size_t before = g_allocations;
+    playouts(engine, 1, PolicyKind::Random, 200, 3, 1);
+    const size_t perCall = g_allocations - before;
+    before = g_allocations;
+    PlayoutStats many = playouts(engine, 64, PolicyKind::Random, 200, 3, 1);
+    ASSERT(many.meanTurns >= 3.0f, "Playouts should run");
+    ASSERT(g_allocations - before == perCall, "Playouts against ScriptedAI should not allocate per battle");
+}
+
+int main() {
+    test_rental_combos();
+    test_wilson_interval();
+    test_evaluate_rental_combos();
+    test_evaluate_swaps();
+    test_playouts();
+    std::cout << "All evaluator tests passed!" << std::endl;
+    return 0;
+}
@@ -58,6 +58,71 @@ void test_opponent_generation() {
     }
 }
 
+void test_fixed_array_generation() {
+    std::cout << "Testing fixed-array generation..." << std::endl;
+    for (int chal = 0; chal < 8; chal++) {
+        for (int open = 0; open < 2; open++) {
+            uint16_t start, end;
+            pkmn::FactoryGenerator::getChallengeRanges(chal, open == 1, start, end);
+
+            uint32_t seed = 1000u + chal * 2 + open;
+            pkmn::FactoryGenerator::RentalPool pool;
+            int count = pkmn::FactoryGenerator::generateRentalPool(seed, chal, open == 1, pool);
+            ASSERT(count == 6, "Fixed rental pool must have 6 mons");
+
+            pkmn::SpeciesSet used;
+            for (uint16_t id : pool) {
+                ASSERT(id >= start && id <= end, "Fixed rental mon ID out of range");
+                uint16_t species = pkmn::getFrontierMon(id).species;
+                ASSERT(!used.test(species), "Duplicate species in rental pool");
+                used.set(species);
+            }
+
+            // Opponents never share a species with the excluded (player) set
+            pkmn::FactoryGenerator::OpponentTeam team;
+            count = pkmn::FactoryGenerator::generateOpponentTeam(seed, chal, 1, open == 1, used, team);
+            ASSERT(count == 3, "Fixed opponent team must have 3 mons");
+            for (uint16_t id : team) {
+                ASSERT(!used.test(pkmn::getFrontierMon(id).species), "Opponent species not excluded");
+                used.set(pkmn::getFrontierMon(id).species);
+            }
+        }
+    }
+
+    // Same seed, same pool
+    uint32_t seedA = 77, seedB = 77;
+    pkmn::FactoryGenerator::RentalPool a, b;
+    pkmn::FactoryGenerator::generateRentalPool(seedA, 3, true, a);
+    pkmn::FactoryGenerator::generateRentalPool(seedB, 3, true, b);
+    ASSERT(a == b && seedA == seedB, "Generation must be deterministic");
+}
+
+void test_batched_generation() {
+    std::cout << "Testing batched generation..." << std::endl;
+    const size_t N = 1000;
+    std::vector<uint32_t> seeds(N);
+    for (size_t i = 0; i < N; i++) seeds[i] = static_cast<uint32_t>(i * 7919);
+
+    // Threaded batch must match the serial per-seed API row for row
+    std::vector<uint16_t> pools(N * 6), teams(N * 3);
+    pkmn::FactoryGenerator::generateRentalPools(seeds.data(), N, 2, true, pools.data(), 4);
+    pkmn::FactoryGenerator::generateOpponentTeams(seeds.data(), N, 2, 1, true, teams.data(), pools.data(), 6, 4);
+
+    for (size_t i = 0; i < N; i++) {
+        uint32_t seed = seeds[i];
+        pkmn::FactoryGenerator::RentalPool pool;
+        pkmn::FactoryGenerator::generateRentalPool(seed, 2, true, pool);
+        for (int k = 0; k < 6; k++) ASSERT(pools[i * 6 + k] == pool[k], "Batched rental pool mismatch");
+
+        pkmn::SpeciesSet excluded;
+        for (uint16_t id : pool) excluded.set(pkmn::getFrontierMon(id).species);
+        seed = seeds[i];
+        pkmn::FactoryGenerator::OpponentTeam team;
+        pkmn::FactoryGenerator::generateOpponentTeam(seed, 2, 1, true, excluded, team);
+        for (int k = 0; k < 3; k++) ASSERT(teams[i * 3 + k] == team[k], "Batched opponent team mismatch");
+    }
+}
+
 void test_pokemon_conversion() {
     std::cout << "Testing pokemon conversion..." << std::endl;
     // Test with Sunkern (ID 0)
@@ -88,6 +153,8 @@ int main() {
     test_challenge_ranges();
     test_rental_generation();
     test_opponent_generation();
+    test_fixed_array_generation();
+    test_batched_generation();
     test_pokemon_conversion();
     std::cout << "All factory tests passed!" << std::endl;
     return 0;
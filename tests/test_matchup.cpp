@@ -0,0 +1,90 @@
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include "matchup_table.hpp"
+#include "factory.hpp"
+
+// Simple test runner
+#define ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "Test failed: " << msg << std::endl; \
+        std::exit(1); \
+    }
+
+void test_build_and_lookup() {
+    std::cout << "Testing matchup table build and lookup..." << std::endl;
+    const char* path = "test_matchups.bin";
+    const uint16_t numMons = 4;
+    pkmn::MatchupTable::build(path, 4, 7, 2, numMons, 100);
+
+    pkmn::MatchupTable table(path);
+    ASSERT(table.isOpen(), "Table should be mapped");
+    ASSERT(table.numMons() == numMons, "numMons mismatch");
+    ASSERT(table.header().version == pkmn::MATCHUP_TABLE_VERSION, "Version mismatch");
+    ASSERT(table.header().samples == 4, "Samples mismatch");
+
+    for (uint16_t a = 0; a < numMons; a++) {
+        for (uint16_t b = 0; b < numMons; b++) {
+            for (int open = 0; open < 2; open++) {
+                float p = table.winRate(a, b, open == 1);
+                ASSERT(p >= 0.0f && p <= 1.0f, "Win rate out of range");
+            }
+        }
+    }
+
+    // Lookups must match a direct re-simulation of the same pair
+    pkmn::Pokemon a = pkmn::FactoryGenerator::createPokemon(1, 50);
+    pkmn::Pokemon b = pkmn::FactoryGenerator::createPokemon(2, 50);
+    float direct = pkmn::MatchupTable::simulateMatchup(a, b, 4, (uint64_t(7) << 32) | (1 * numMons + 2), 100);
+    ASSERT(std::abs(direct - table.winRate(1, 2, false)) < 1e-4f, "Lookup differs from simulation");
+
+    // Ids past a small table's numMons are rejected by the checked lookup
+    ASSERT(table.winRateAt(1, 2, false) == table.winRate(1, 2, false), "Checked lookup mismatch");
+    bool threw = false;
+    try {
+        table.winRateAt(numMons, 0, false);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    ASSERT(threw, "Out-of-range id should throw");
+
+    pkmn::MatchupTable closed;
+    ASSERT(closed.numMons() == 0, "Closed table should have no mons");
+    threw = false;
+    try {
+        closed.winRateAt(0, 0, false);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    ASSERT(threw, "Lookup on a closed table should throw");
+
+    pkmn::MatchupTable moved(std::move(table));
+    ASSERT(moved.isOpen() && !table.isOpen(), "Move should transfer the mapping");
+
+    std::remove(path);
+}
+
+void test_bad_file() {
+    std::cout << "Testing malformed table rejection..." << std::endl;
+    const char* path = "test_bad_matchups.bin";
+    FILE* f = std::fopen(path, "wb");
+    std::fputs("not a table", f);
+    std::fclose(f);
+
+    bool threw = false;
+    try {
+        pkmn::MatchupTable table(path);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "Malformed table should throw");
+    std::remove(path);
+}
+
+int main() {
+    test_build_and_lookup();
+    test_bad_file();
+    std::cout << "All matchup tests passed!" << std::endl;
+    return 0;
+}
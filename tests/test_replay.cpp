@@ -0,0 +1,208 @@
+#include "replay.hpp"
+#include "factory.hpp"
+#include "policy.hpp"
+#include "rng.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <stdexcept>
+
+// Simple test runner
+#define ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "Test failed: " << msg << std::endl; \
+        std::exit(1); \
+    }
+
+using namespace pkmn;
+
+static Replay recordGame(uint64_t seed, uint32_t game, bool bothSides, bool counterRng = false) {
+    Replay replay;
+    uint32_t poolSeed = deriveSeed(seed, 0, game);
+    FactoryGenerator::RentalPool pool;
+    FactoryGenerator::generateRentalPool(poolSeed, 0, false, pool);
+    for (int k = 0; k < 6; k++) replay.teamIds[k] = pool[k];
+    replay.seed = deriveSeed(seed, 1, game);
+    replay.opponentPolicy = Policy(PolicyKind::ScriptedAI);
+
+    BattleEngine engine;
+    startReplay(engine, replay);
+    if (counterRng) {
+        engine.setRngMode(RngMode::Counter);
+        engine.seedCounterRng(counterRngKey(seed, 0, game));
+    }
+    while (!engine.isTerminal() && engine.getTurnCount() < 200) {
+        Action legal[MAX_LEGAL_ACTIONS];
+        int count = engine.getLegalActions(0, legal);
+        Action player = legal[deriveSeed(seed, 2 + game, replay.actions.size()) % count];
+        if (bothSides) {
+            Action opponent = choosePolicyAction(engine, 1, Policy(PolicyKind::MaxDamage));
+            recordStepBoth(engine, replay, player, opponent);
+        } else {
+            recordStep(engine, replay, player);
+        }
+    }
+    return replay;
+}
+
+static void test_verify_recorded() {
+    std::cout << "Testing replay verification..." << std::endl;
+
+    std::vector<Replay> replays;
+    for (uint32_t g = 0; g < 24; g++) replays.push_back(recordGame(7, g, g % 3 == 0));
+
+    for (const Replay& replay : replays) {
+        ASSERT(!replay.actions.empty(), "Recorded replay should have turns");
+        ASSERT(replay.actions.size() == replay.hashChecks.size(), "One hash check per turn");
+        ReplayVerification v = verifyReplay(replay);
+        ASSERT(v.ok(), "Freshly recorded replay should verify");
+        ASSERT(v.turns == replay.actions.size(), "Verification should re-simulate every turn");
+    }
+
+    std::vector<ReplayVerification> results = verifyReplays(replays, 4);
+    ASSERT(results.size() == replays.size(), "One result per replay");
+    for (const ReplayVerification& v : results) ASSERT(v.ok(), "Parallel verification should match serial");
+
+    std::cout << "  Replay verification passed" << std::endl;
+}
+
+static void test_detects_divergence() {
+    std::cout << "Testing replay divergence detection..." << std::endl;
+
+    Replay replay = recordGame(11, 0, false);
+    ASSERT(replay.actions.size() > 2, "Need a few turns to tamper with");
+
+    Replay badHash = replay;
+    badHash.hashChecks[1] ^= 1;
+    ReplayVerification v = verifyReplay(badHash);
+    ASSERT(!v.ok() && v.divergedTurn == 1, "Corrupted hash should be reported on its turn");
+
+    Replay badWinner = replay;
+    badWinner.winner = static_cast<int8_t>(replay.winner == 0 ? 1 : 0);
+    v = verifyReplay(badWinner);
+    ASSERT(v.divergedTurn < 0 && !v.winnerMatches, "Wrong winner should be reported");
+
+    Replay badSeed = replay;
+    badSeed.seed ^= 0x5a5a5a5a;
+    v = verifyReplay(badSeed);
+    ASSERT(!v.ok(), "A different seed should not verify");
+
+    std::cout << "  Replay divergence detection passed" << std::endl;
+}
+
+static void test_file_roundtrip() {
+    std::cout << "Testing replay file roundtrip..." << std::endl;
+
+    std::vector<Replay> replays;
+    for (uint32_t g = 0; g < 10; g++) replays.push_back(recordGame(3, g, g % 2 == 1));
+
+    const std::string path = (std::filesystem::temp_directory_path() / "test_replay_roundtrip.rpl").string();
+    {
+        ReplayWriter writer(path);
+        for (const Replay& replay : replays) writer.write(replay);
+        ASSERT(writer.count() == replays.size(), "Writer should count replays");
+        writer.close();
+    }
+
+    std::vector<Replay> loaded = readReplays(path);
+    ASSERT(loaded.size() == replays.size(), "Should read back every replay");
+    for (size_t i = 0; i < replays.size(); i++) {
+        const Replay& a = replays[i];
+        const Replay& b = loaded[i];
+        ASSERT(a.seed == b.seed && a.teamIds == b.teamIds && a.level == b.level, "Header should roundtrip");
+        ASSERT(a.opponentPolicy.kind == b.opponentPolicy.kind, "Opponent policy should roundtrip");
+        ASSERT(a.bothSides == b.bothSides && a.winner == b.winner, "Flags and winner should roundtrip");
+        ASSERT(a.actions == b.actions && a.hashChecks == b.hashChecks, "Turns should roundtrip");
+        ASSERT(verifyReplay(b).ok(), "Loaded replay should verify");
+    }
+
+    // Truncated file
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 3));
+    }
+    bool threw = false;
+    try {
+        readReplays(path);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "Truncated replay file should throw");
+
+    // Not a replay file
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "not a replay";
+    }
+    threw = false;
+    try {
+        ReplayReader reader(path);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "Bad magic should throw");
+
+    std::remove(path.c_str());
+    std::cout << "  Replay file roundtrip passed" << std::endl;
+}
+
+static void test_counter_mode() {
+    std::cout << "Testing counter-mode replays..." << std::endl;
+
+    std::vector<Replay> replays;
+    for (uint32_t g = 0; g < 6; g++) replays.push_back(recordGame(5, g, g % 2 == 1, true));
+
+    for (uint32_t g = 0; g < replays.size(); g++) {
+        const Replay& replay = replays[g];
+        ASSERT(replay.rngMode == RngMode::Counter, "Replay should record the RNG mode");
+        ASSERT(replay.rngKey == counterRngKey(5, 0, g) && replay.rngCounter == 0,
+               "Replay should record the seedCounterRng stream");
+        ASSERT(verifyReplay(replay).ok(), "Counter-mode replay should verify");
+    }
+
+    const std::string path = (std::filesystem::temp_directory_path() / "test_replay_counter.rpl").string();
+    {
+        ReplayWriter writer(path);
+        writer.write(recordGame(5, 0, false));
+        for (const Replay& replay : replays) writer.write(replay);
+        writer.close();
+    }
+    std::vector<Replay> loaded = readReplays(path);
+    std::remove(path.c_str());
+    ASSERT(loaded.size() == replays.size() + 1, "Should read back every replay");
+    ASSERT(loaded[0].rngMode == RngMode::GameLCG && verifyReplay(loaded[0]).ok(),
+           "LCG replay should roundtrip next to counter-mode ones");
+    for (size_t i = 0; i < replays.size(); i++) {
+        const Replay& a = replays[i];
+        const Replay& b = loaded[i + 1];
+        ASSERT(b.rngMode == RngMode::Counter && a.rngKey == b.rngKey && a.rngCounter == b.rngCounter,
+               "RNG mode and stream should roundtrip");
+        ASSERT(a.actions == b.actions && a.hashChecks == b.hashChecks, "Turns should roundtrip");
+        ASSERT(verifyReplay(b).ok(), "Loaded counter-mode replay should verify");
+
+        Replay lcg = b;
+        lcg.rngMode = RngMode::GameLCG;
+        ASSERT(!verifyReplay(lcg).ok(), "Counter-mode replay re-simulated with the LCG should diverge");
+        Replay rekeyed = b;
+        rekeyed.rngKey = splitMix64(b.seed);
+        ASSERT(!verifyReplay(rekeyed).ok(), "Counter-mode replay with the reset() key should diverge");
+    }
+
+    std::cout << "  Counter-mode replays passed" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Replay Tests ===" << std::endl;
+
+    test_verify_recorded();
+    test_detects_divergence();
+    test_file_roundtrip();
+    test_counter_mode();
+
+    std::cout << "\nAll replay tests passed!" << std::endl;
+    return 0;
+}
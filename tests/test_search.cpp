@@ -0,0 +1,623 @@
+#include "battle_engine.hpp"
+#include "endgame.hpp"
+#include "expectiminimax.hpp"
+#include "factory.hpp"
+#include "matrix_game.hpp"
+#include "mcts.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+#include "transposition.hpp"
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <set>
+
+// Simple test runner
+#define ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "Test failed: " << msg << std::endl; \
+        std::exit(1); \
+    }
+
+using namespace pkmn;
+
+static void setupFactoryBattle(BattleEngine& engine, uint32_t seed) {
+    uint32_t genSeed = seed;
+    FactoryGenerator::RentalPool pool;
+    FactoryGenerator::generateRentalPool(genSeed, 0, false, pool);
+
+    Pokemon player[3], opponent[3];
+    for (int i = 0; i < 3; i++) {
+        player[i] = FactoryGenerator::createPokemon(pool[i], 50);
+        opponent[i] = FactoryGenerator::createPokemon(pool[i + 3], 50);
+    }
+    engine.reset(seed);
+    engine.setPlayerTeam(player, 3);
+    engine.setOpponentTeam(opponent, 3);
+}
+
+static void setupSingles(BattleEngine& engine, uint32_t seed) {
+    uint32_t genSeed = seed;
+    FactoryGenerator::RentalPool pool;
+    FactoryGenerator::generateRentalPool(genSeed, 0, false, pool);
+    Pokemon player = FactoryGenerator::createPokemon(pool[0], 50);
+    Pokemon opponent = FactoryGenerator::createPokemon(pool[1], 50);
+    engine.reset(seed);
+    engine.setPlayerTeam(&player, 1);
+    engine.setOpponentTeam(&opponent, 1);
+}
+
+static bool isLegal(const BattleEngine& engine, Action action) {
+    Action legal[MAX_LEGAL_ACTIONS];
+    int count = engine.getLegalActions(0, legal);
+    for (int i = 0; i < count; i++) {
+        if (legal[i].type == action.type) return true;
+    }
+    return false;
+}
+
+static uint32_t rootVisits(const MctsResult& result) {
+    uint32_t total = 0;
+    for (int a = 0; a < MCTS_NUM_ACTIONS; a++) total += result.visits[a];
+    return total;
+}
+
+void test_mcts_iterations() {
+    std::cout << "Testing MCTS iteration budget..." << std::endl;
+    BattleEngine engine;
+    setupFactoryBattle(engine, 7);
+    const uint32_t turnBefore = engine.getTurnCount();
+
+    MctsConfig config;
+    config.iterations = 300;
+    config.rolloutPolicy = PolicyKind::MaxDamage;
+    MctsSearch search(config);
+    MctsResult result = search.search(engine);
+
+    ASSERT(result.iterations == 300, "Iteration budget mismatch");
+    // The first iteration expands the root, every other one visits a child
+    ASSERT(rootVisits(result) == 299, "Root child visits should account for every iteration");
+    ASSERT(isLegal(engine, result.bestAction), "Best action must be legal");
+    ASSERT(engine.getTurnCount() == turnBefore, "Search must not modify the root");
+    for (int a = 0; a < MCTS_NUM_ACTIONS; a++) {
+        ASSERT(result.values[a] >= 0.0f && result.values[a] <= 1.0f, "Value out of range");
+    }
+
+    // Same seed, same tree
+    MctsResult again = search.search(engine);
+    for (int a = 0; a < MCTS_NUM_ACTIONS; a++) {
+        ASSERT(again.visits[a] == result.visits[a], "Single-threaded search must be deterministic");
+    }
+}
+
+void test_mcts_parallel() {
+    std::cout << "Testing parallel MCTS with virtual loss..." << std::endl;
+    BattleEngine engine;
+    setupFactoryBattle(engine, 11);
+
+    MctsConfig config;
+    config.iterations = 400;
+    config.numThreads = 4;
+    config.virtualLoss = 3;
+    config.rolloutPolicy = PolicyKind::MaxDamage;
+    MctsSearch search(config);
+    MctsResult result = search.search(engine);
+
+    ASSERT(result.iterations == 400, "Iteration budget mismatch");
+    // Only the iteration that expands the root stops there; threads racing it wait
+    ASSERT(rootVisits(result) == 399, "Virtual visits must all be reverted");
+    ASSERT(isLegal(engine, result.bestAction), "Best action must be legal");
+}
+
+void test_mcts_arena_and_time_budget() {
+    std::cout << "Testing MCTS arena limit and time budget..." << std::endl;
+    BattleEngine engine;
+    setupFactoryBattle(engine, 3);
+
+    MctsConfig config;
+    config.iterations = 0;
+    config.timeBudgetMs = 20.0;
+    config.maxNodes = 1 + 2 * MCTS_NUM_ACTIONS;
+    config.rolloutPolicy = PolicyKind::Random;
+    MctsSearch search(config);
+    MctsResult result = search.search(engine);
+
+    ASSERT(result.iterations > 0, "Time-budgeted search should run");
+    ASSERT(result.nodesUsed <= config.maxNodes, "Arena capacity exceeded");
+    ASSERT(isLegal(engine, result.bestAction), "Best action must be legal");
+}
+
+void test_mcts_leaf_evaluator() {
+    std::cout << "Testing PUCT with a leaf evaluator..." << std::endl;
+    BattleEngine engine;
+    setupFactoryBattle(engine, 5);
+
+    std::atomic<uint32_t> calls{0};
+    MctsConfig config;
+    config.iterations = 200;
+    config.selection = SelectionRule::PUCT;
+    config.numThreads = 2;
+    // Flat values with all prior mass on the first move
+    config.evaluator = [&calls](const BattleEngine&, float* priors) {
+        calls.fetch_add(1);
+        for (int a = 0; a < MCTS_NUM_ACTIONS; a++) priors[a] = 0.0f;
+        priors[static_cast<uint8_t>(ActionType::Move1)] = 1.0f;
+        return 0.5f;
+    };
+    MctsSearch search(config);
+    MctsResult result = search.search(engine);
+
+    // Terminal positions are scored directly; everything else goes through the evaluator
+    ASSERT(calls.load() > 0 && calls.load() <= 200, "Evaluator should replace rollouts");
+    ASSERT(result.bestAction.type == ActionType::Move1, "Search should follow the prior");
+}
+
+void test_ismcts_determinization() {
+    std::cout << "Testing ISMCTS determinization of hidden opponents..." << std::endl;
+    BattleEngine engine;
+    setupFactoryBattle(engine, 9);
+    const BattleState& state = engine.getState();
+    ASSERT(state.revealedMask[1] == 1, "Only the opponent lead is revealed at the start");
+
+    const uint16_t leadSpecies = state.teams[1][0].species;
+    std::mutex mutex;
+    std::set<uint16_t> backLineSpecies;
+    bool leadChanged = false;
+
+    MctsConfig config;
+    config.iterations = 200;
+    config.numThreads = 2;
+    config.determinize = true;
+    config.challengeNum = 0;
+    config.memoryBudgetBytes = 64 * 1024;
+    config.evaluator = [&](const BattleEngine& e, float*) {
+        const BattleState& s = e.getState();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!(s.revealedMask[1] & 2)) backLineSpecies.insert(s.teams[1][1].species);
+        if (s.teams[1][0].species != leadSpecies) leadChanged = true;
+        return 0.5f;
+    };
+    MctsSearch search(config);
+    ASSERT(search.capacity() == MctsSearch::nodesForBudget(64 * 1024), "Arena should follow the memory budget");
+    MctsResult result = search.search(engine);
+
+    ASSERT(!leadChanged, "Revealed mons must never be resampled");
+    ASSERT(backLineSpecies.size() > 1, "Hidden mons should vary between determinizations");
+    ASSERT(result.nodesUsed <= search.capacity(), "Arena capacity exceeded");
+    ASSERT(isLegal(engine, result.bestAction), "Best action must be legal");
+
+    // Switching in reveals the slot
+    Action legal[MAX_LEGAL_ACTIONS];
+    int count = engine.getLegalActions(0, legal);
+    for (int i = 0; i < count; i++) {
+        if (legal[i].isSwitch()) {
+            engine.step(legal[i]);
+            ASSERT(state.revealedMask[0] & (1u << legal[i].getSwitchTarget()), "Switch target should be revealed");
+            break;
+        }
+    }
+}
+
+void test_regret_matching() {
+    std::cout << "Testing regret matching on known games..." << std::endl;
+    // Rock-paper-scissors (win = 1, tie = 0.5, loss = 0): uniform, value 0.5
+    const float rps[9] = {0.5f, 0.0f, 1.0f,
+                          1.0f, 0.5f, 0.0f,
+                          0.0f, 1.0f, 0.5f};
+    float x[3], y[3];
+    float value = solveMatrixGame(rps, 3, 3, 5000, x, y);
+    ASSERT(std::abs(value - 0.5f) < 0.01f, "RPS value should be 0.5");
+    for (int i = 0; i < 3; i++) {
+        ASSERT(std::abs(x[i] - 1.0f / 3) < 0.02f && std::abs(y[i] - 1.0f / 3) < 0.02f, "RPS strategy should be uniform");
+    }
+
+    // Dominated row: the row player always takes row 1
+    const float dominated[4] = {0.2f, 0.4f,
+                                0.6f, 0.8f};
+    value = solveMatrixGame(dominated, 2, 2, 2000, x, y);
+    ASSERT(x[1] > 0.99f && y[0] > 0.99f, "Pure saddle point expected");
+    ASSERT(std::abs(value - 0.6f) < 0.01f, "Saddle point value mismatch");
+}
+
+void test_solve_turn() {
+    std::cout << "Testing simultaneous-move turn solver..." << std::endl;
+    BattleEngine engine;
+    setupFactoryBattle(engine, 13);
+    const uint16_t turnBefore = engine.getTurnCount();
+
+    MatrixGameConfig config;
+    config.samples = 4;
+    config.seed = 21;
+    config.numThreads = 3;
+    MatrixGameSolution a = solveTurn(engine, config);
+    config.numThreads = 1;
+    MatrixGameSolution b = solveTurn(engine, config);
+
+    Action legal[MAX_LEGAL_ACTIONS];
+    ASSERT(a.rows == engine.getLegalActions(0, legal), "Rows should be the player's legal actions");
+    ASSERT(a.cols == engine.getLegalActions(1, legal), "Columns should be the opponent's legal actions");
+    ASSERT(engine.getTurnCount() == turnBefore, "Solver must not modify the root");
+
+    float rowTotal = 0.0f, colTotal = 0.0f;
+    for (int i = 0; i < a.rows; i++) rowTotal += a.rowStrategy[i];
+    for (int j = 0; j < a.cols; j++) colTotal += a.colStrategy[j];
+    ASSERT(std::abs(rowTotal - 1.0f) < 1e-4f && std::abs(colTotal - 1.0f) < 1e-4f, "Strategies must sum to 1");
+    ASSERT(a.value >= 0.0f && a.value <= 1.0f, "Value out of range");
+    ASSERT(a.exploitability < 0.05f, "Solution should be close to Nash");
+    for (int i = 0; i < a.rows; i++)
+        for (int j = 0; j < a.cols; j++)
+            ASSERT(a.payoff[i][j] == b.payoff[i][j], "Payoffs must not depend on thread count");
+
+    // Depth-limited cells solve the next turn instead of rolling out
+    config.depth = 2;
+    config.samples = 1;
+    config.numThreads = 0;
+    MatrixGameSolution deep = solveTurn(engine, config);
+    ASSERT(deep.rows == a.rows && deep.value >= 0.0f && deep.value <= 1.0f, "Depth-2 solve failed");
+}
+
+void test_turn_outcomes() {
+    std::cout << "Testing chance outcome enumeration..." << std::endl;
+    BattleEngine engine;
+    setupFactoryBattle(engine, 19);
+    Action player[MAX_LEGAL_ACTIONS], opponent[MAX_LEGAL_ACTIONS];
+    int numPlayer = engine.getLegalActions(0, player);
+    int numOpponent = engine.getLegalActions(1, opponent);
+
+    ChanceModel model;
+    for (int i = 0; i < numPlayer; i++) {
+        for (int j = 0; j < numOpponent; j++) {
+            WeightedOutcome outcomes[MAX_TURN_OUTCOMES];
+            int count = engine.enumerateTurnOutcomes(player[i], opponent[j], model, outcomes);
+            ASSERT(count >= 1 && count <= MAX_TURN_OUTCOMES, "Outcome count out of range");
+            float total = 0.0f;
+            for (int k = 0; k < count; k++) total += outcomes[k].probability;
+            ASSERT(std::abs(total - 1.0f) < 1e-4f, "Outcome probabilities must sum to 1");
+        }
+    }
+
+    // Forced turns are deterministic, leave the RNG alone, and respect the roll
+    const uint32_t rngBefore = engine.getState().rngState;
+    TurnOutcome low, high;
+    for (int k = 0; k < 2; k++) {
+        low.moves[k] = MoveOutcome{true, false, 85};
+        high.moves[k] = MoveOutcome{true, false, 100};
+    }
+    BattleEngine a = engine, b = engine, c = engine;
+    a.stepWithOutcome(Action{ActionType::Move1}, Action{ActionType::Move1}, high);
+    b.stepWithOutcome(Action{ActionType::Move1}, Action{ActionType::Move1}, high);
+    c.stepWithOutcome(Action{ActionType::Move1}, Action{ActionType::Move1}, low);
+    ASSERT(a.getState().rngState == rngBefore, "Forced turns must not draw from the RNG");
+    for (int side = 0; side < 2; side++) {
+        uint16_t hpHigh = a.getState().getActivePokemon(side).currentHP;
+        ASSERT(hpHigh == b.getState().getActivePokemon(side).currentHP, "Forced turns must be deterministic");
+        ASSERT(hpHigh <= c.getState().getActivePokemon(side).currentHP, "Top rolls can't deal less damage");
+    }
+}
+
+void test_expectiminimax() {
+    std::cout << "Testing expectiminimax pruning..." << std::endl;
+    BattleEngine engine;
+    setupSingles(engine, 23);
+
+    ExpectiminimaxConfig config;
+    config.maxDepth = 2;
+    config.chance.damageBuckets = 2;
+    config.chance.branchCrits = false;
+
+    config.prune = false;
+    ExpectiminimaxResult plain = searchExpectiminimax(engine, config);
+    config.prune = true;
+    config.star2 = false;
+    ExpectiminimaxResult star1 = searchExpectiminimax(engine, config);
+    config.star2 = true;
+    ExpectiminimaxResult star2 = searchExpectiminimax(engine, config);
+
+    ASSERT(plain.depthReached == 2 && star1.depthReached == 2 && star2.depthReached == 2, "Depth not reached");
+    ASSERT(std::abs(plain.value - star1.value) < 1e-4f, "Star1 must not change the value");
+    ASSERT(std::abs(plain.value - star2.value) < 1e-4f, "Star2 must not change the value");
+    ASSERT(star1.nodes <= plain.nodes, "Pruning should not search more nodes");
+    ASSERT(isLegal(engine, star2.bestAction), "Best action must be legal");
+
+    // Iterative deepening stops on the clock with the last finished depth
+    config.maxDepth = 50;
+    config.timeBudgetMs = 30.0;
+    config.chance = ChanceModel{};
+    ExpectiminimaxResult timed = searchExpectiminimax(engine, config);
+    ASSERT(timed.depthReached >= 1, "At least one iteration should finish");
+    ASSERT(timed.elapsedMs < 1000.0, "Time budget ignored");
+}
+
+void test_endgame_solver() {
+    std::cout << "Testing 1v1 endgame solver..." << std::endl;
+    BattleEngine engine;
+    setupSingles(engine, 3);
+
+    EndgameConfig config;
+    config.chance.damageBuckets = 2;
+    EndgameSolver solver(config);
+
+    EndgameSolution solution;
+    ASSERT(solver.solve(engine, solution), "1v1 position should solve");
+    ASSERT(solution.value >= 0.0f && solution.value <= 1.0f, "Value out of range");
+    float playerTotal = 0.0f, opponentTotal = 0.0f;
+    for (int a = 0; a < NUM_ACTION_TYPES; a++) {
+        playerTotal += solution.playerPolicy[a];
+        opponentTotal += solution.opponentPolicy[a];
+    }
+    ASSERT(std::abs(playerTotal - 1.0f) < 1e-3f, "Player policy should sum to 1");
+    ASSERT(std::abs(opponentTotal - 1.0f) < 1e-3f, "Opponent policy should sum to 1");
+
+    // Second query is a table hit, whatever the RNG state
+    size_t size = solver.size();
+    ASSERT(size > 1, "Successors should be memoized");
+    engine.setRngState(12345);
+    ASSERT(solver.value(engine) == solution.value, "Lookup must match the solve");
+    ASSERT(solver.size() == size, "Lookup must not grow the table");
+
+    BattleEngine full;
+    setupFactoryBattle(full, 3);
+    ASSERT(!solver.solve(full, solution), "3v3 is not an endgame");
+    ASSERT(solver.value(full) < 0.0f, "3v3 has no endgame value");
+
+    solver.clear();
+    ASSERT(solver.size() == 0, "Clear should empty the table");
+}
+
+// 1 HP player, faster, needing one of `zapPP` 50% Zap Cannons on a 1 HP foe
+// that only Splashes. Out of PP it must Struggle, and the recoil faints it
+// too, which counts as a loss: the exact value is 1 - 0.5^zapPP.
+static void setupZapEndgame(BattleEngine& engine, uint8_t zapPP) {
+    Pokemon player = FactoryGenerator::createPokemon(1, 50);  // Normal type: Zap Cannon and Struggle connect
+    Pokemon opponent = player;
+    for (Pokemon* mon : {&player, &opponent}) {
+        mon->heldItem = 0;
+        mon->currentHP = 1;
+        for (int i = 0; i < MAX_MOVES; i++) {
+            mon->moves[i] = MOVE_NONE;
+            mon->pp[i] = 0;
+        }
+    }
+    player.moves[0] = MOVE_ZAP_CANNON;
+    player.pp[0] = zapPP;
+    player.stats[Stat::Speed] = 200;
+    opponent.moves[0] = MOVE_SPLASH;
+    opponent.pp[0] = 40;
+    opponent.stats[Stat::Speed] = 10;
+    engine.reset(1);
+    engine.setPlayerTeam(&player, 1);
+    engine.setOpponentTeam(&opponent, 1);
+}
+
+// A Splashing 10 HP player with Leftovers against Pound, weakened so a hit
+// is about what Leftovers heals: HP wanders up and down, so positions recur
+static void setupLeftoversEndgame(BattleEngine& engine) {
+    Pokemon player = FactoryGenerator::createPokemon(1, 50);
+    Pokemon opponent = player;
+    for (Pokemon* mon : {&player, &opponent}) {
+        for (int i = 0; i < MAX_MOVES; i++) {
+            mon->moves[i] = MOVE_NONE;
+            mon->pp[i] = 0;
+        }
+    }
+    player.heldItem = ITEM_LEFTOVERS;
+    player.currentHP = 10;
+    player.moves[0] = MOVE_SPLASH;
+    player.pp[0] = 40;
+    player.stats[Stat::Defense] = 250;
+    opponent.heldItem = 0;
+    opponent.moves[0] = MOVE_POUND;
+    opponent.pp[0] = 35;
+    engine.reset(1);
+    engine.setPlayerTeam(&player, 1);
+    engine.setOpponentTeam(&opponent, 1);
+}
+
+void test_endgame_exact_values() {
+    std::cout << "Testing endgame solver exact values..." << std::endl;
+
+    // Remaining PP decides the value, up to the cap
+    EndgameSolver solver;
+    for (uint8_t pp = 1; pp <= ENDGAME_PP_CAP; pp++) {
+        BattleEngine engine;
+        setupZapEndgame(engine, pp);
+        float expected = 1.0f - std::pow(0.5f, pp);
+        ASSERT(std::abs(solver.value(engine) - expected) < 1e-5f, "Zap Cannon endgame with " << int(pp) << " PP");
+    }
+
+    // Recurring positions: every memoized value must match a fresh solve
+    // from that position, not one built around an unsolved ancestor
+    BattleEngine engine;
+    setupLeftoversEndgame(engine);
+    EndgameConfig config;
+    config.chance.damageBuckets = 2;
+    EndgameSolver shared(config);
+    shared.value(engine);
+    for (uint32_t walk = 0; walk < 4; walk++) {
+        BattleEngine position = engine;
+        position.setRngState(walk);
+        for (int turn = 0; turn < 6 && isOneVsOne(position); turn++) {
+            EndgameSolver fresh(config);
+            ASSERT(std::abs(shared.value(position) - fresh.value(position)) < 1e-4f,
+                   "Memoized value differs from a fresh solve");
+            position.stepBoth(Action{ActionType::Move1}, Action{ActionType::Move1});
+        }
+    }
+}
+
+void test_transposition_table() {
+    std::cout << "Testing transposition table..." << std::endl;
+    TranspositionTable table(1);
+    ASSERT(table.sizeBytes() == 1 << 20, "1 MB should be exactly 16384 buckets");
+    const uint64_t bucketStride = table.capacity() / 4;  // Keys this far apart share a bucket
+
+    TTEntry entry;
+    entry.value = 0.625f;
+    entry.visits = 7;
+    entry.bestAction = 3;
+    entry.depth = 10;
+    entry.bound = Bound::Lower;
+    table.store(42, entry);
+
+    TTEntry out;
+    ASSERT(table.probe(42, out), "Stored key should hit");
+    ASSERT(std::abs(out.value - 0.625f) < 1e-6f && out.visits == 7 && out.bestAction == 3 &&
+           out.depth == 10 && out.bound == Bound::Lower, "Entry should round-trip");
+    ASSERT(!table.probe(43, out) && !table.probe(42 + bucketStride, out), "Other keys should miss");
+
+    // A full bucket evicts its shallowest entry; the deep one survives
+    TTEntry shallow;
+    shallow.depth = 1;
+    for (uint64_t k = 1; k <= 4; k++) table.store(42 + k * bucketStride, shallow);
+    ASSERT(table.probe(42, out) && out.depth == 10, "Deep entry should survive");
+
+    // Once stale it goes before fresh shallow entries
+    table.clear();
+    table.store(42, entry);
+    for (int g = 0; g < 2; g++) table.newGeneration();
+    for (uint64_t k = 1; k <= 4; k++) table.store(42 + k * bucketStride, shallow);
+    ASSERT(!table.probe(42, out), "Stale deep entry should be replaced");
+    ASSERT(table.hashfull() > 0, "Current generation has entries");
+    ASSERT(table.countUsed() == 4, "Only the four fresh entries are this generation's");
+    table.clear();
+    ASSERT(table.hashfull() == 0 && table.countUsed() == 0 && !table.probe(42 + 4 * bucketStride, out), "Clear should empty the table");
+
+    // Racing writers: a hit must never return another key's data
+    const uint64_t keys = 1 << 16;
+    std::atomic<int> bad{0};
+    parallelFor(keys * 4, 4, 256, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            uint64_t key = splitMix64(i % keys);
+            TTEntry e;
+            e.depth = static_cast<uint8_t>(key >> 56);
+            e.visits = static_cast<uint32_t>(key & 0xFFFF);
+            table.store(key, e);
+            TTEntry got;
+            uint64_t other = splitMix64((i * 7) % keys);
+            if (table.probe(other, got) &&
+                (got.depth != static_cast<uint8_t>(other >> 56) || got.visits != (other & 0xFFFF))) {
+                bad++;
+            }
+        }
+    });
+    ASSERT(bad == 0, "Torn or foreign entries must read as misses");
+}
+
+void test_search_with_table() {
+    std::cout << "Testing searches sharing a transposition table..." << std::endl;
+    BattleEngine engine;
+    setupSingles(engine, 23);
+    TranspositionTable table(4);
+
+    ExpectiminimaxConfig config;
+    config.maxDepth = 2;
+    config.chance.damageBuckets = 2;
+    config.chance.branchCrits = false;
+    ExpectiminimaxResult plain = searchExpectiminimax(engine, config);
+    config.table = &table;
+    ExpectiminimaxResult first = searchExpectiminimax(engine, config);
+    ExpectiminimaxResult second = searchExpectiminimax(engine, config);
+    ASSERT(std::abs(plain.value - first.value) < 1e-4f, "Table must not change the value");
+    ASSERT(std::abs(plain.value - second.value) < 1e-4f, "Table hits must not change the value");
+    ASSERT(second.nodes < first.nodes, "A warm table should save work");
+
+    // MCTS threads sharing the same table
+    BattleEngine full;
+    setupFactoryBattle(full, 11);
+    table.newGeneration();
+    MctsConfig mcts;
+    mcts.iterations = 400;
+    mcts.numThreads = 4;
+    mcts.rolloutPolicy = PolicyKind::MaxDamage;
+    mcts.table = &table;
+    MctsSearch search(mcts);
+    MctsResult result = search.search(full);
+    ASSERT(result.iterations == 400, "Iteration budget mismatch");
+    ASSERT(isLegal(full, result.bestAction), "Best action must be legal");
+    ASSERT(table.countUsed() > 0, "Leaf estimates should be stored");
+}
+
+void test_table_solved_marker() {
+    std::cout << "Testing solved table entries..." << std::endl;
+
+    // Two Zap Cannons: after a miss, every line ends within two more turns.
+    // The root isn't stored, so look at the position after the miss.
+    BattleEngine endgame;
+    setupZapEndgame(endgame, 2);
+    WeightedOutcome outcomes[MAX_TURN_OUTCOMES];
+    ChanceModel chance{2, false};
+    const Action zap{ActionType::Move1};
+    const int count = endgame.enumerateTurnOutcomes(zap, zap, chance, outcomes);
+    uint64_t missKey = 0;
+    for (int k = 0; k < count; k++) {
+        BattleEngine next = endgame;
+        next.stepWithOutcome(zap, zap, outcomes[k].outcome);
+        if (!next.isTerminal()) missKey = next.getHash();
+    }
+    ASSERT(missKey != 0, "Zap Cannon should be able to miss");
+
+    TranspositionTable solvedTable(1);
+    ExpectiminimaxConfig config;
+    config.chance = chance;
+    config.prune = false;  // Every stored value exact
+    config.table = &solvedTable;
+    config.maxDepth = 2;
+    searchExpectiminimax(endgame, config);
+    TTEntry entry;
+    ASSERT(solvedTable.probe(missKey, entry) && entry.bound == Bound::Exact && entry.depth == 1,
+           "A search cut off by its depth is exact only to that depth");
+    config.maxDepth = 3;
+    searchExpectiminimax(endgame, config);
+    ASSERT(solvedTable.probe(missKey, entry) && entry.bound == Bound::Exact && entry.depth == TT_DEPTH_SOLVED,
+           "A search reaching the end of every line is solved");
+
+    // MCTS trusts only solved entries; a depth-limited one doesn't replace the evaluator
+    BattleEngine engine;
+    setupFactoryBattle(engine, 11);
+    TranspositionTable table(1);
+    std::atomic<uint32_t> calls{0};
+    MctsConfig mcts;
+    mcts.iterations = 1;
+    mcts.numThreads = 1;
+    mcts.table = &table;
+    mcts.evaluator = [&calls](const BattleEngine&, float*) {
+        calls.fetch_add(1);
+        return 0.25f;
+    };
+    TTEntry estimate;
+    estimate.value = 0.75f;
+    estimate.depth = 1;
+    estimate.bound = Bound::Exact;
+    table.store(engine.getHash(), estimate);
+    MctsSearch(mcts).search(engine);
+    ASSERT(calls.load() == 1, "A depth-limited value should not skip the evaluator");
+    TTEntry out;
+    ASSERT(table.probe(engine.getHash(), out) && out.bound == Bound::Exact && out.depth == 1,
+           "The search's entry should be kept");
+
+    estimate.depth = TT_DEPTH_SOLVED;
+    table.store(engine.getHash(), estimate);
+    calls = 0;
+    MctsSearch(mcts).search(engine);
+    ASSERT(calls.load() == 0, "A solved value should replace the evaluator");
+}
+
+int main() {
+    test_mcts_iterations();
+    test_mcts_parallel();
+    test_mcts_arena_and_time_budget();
+    test_mcts_leaf_evaluator();
+    test_ismcts_determinization();
+    test_regret_matching();
+    test_solve_turn();
+    test_turn_outcomes();
+    test_expectiminimax();
+    test_endgame_solver();
+    test_endgame_exact_values();
+    test_transposition_table();
+    test_search_with_table();
+    test_table_solved_marker();
+    std::cout << "All search tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,247 @@
+#include "trajectory.hpp"
+#include "factory.hpp"
+#include "observation.hpp"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Simple test runner
+#define ASSERT(cond, msg) \
+    if (!(cond)) { \
+        std::cerr << "Test failed: " << msg << std::endl; \
+        std::exit(1); \
+    }
+
+using namespace pkmn;
+
+static constexpr size_t NUM_ENVS = 12;
+
+static void setupEnv(VecBattleEnv& env) {
+    std::vector<uint32_t> seeds(NUM_ENVS);
+    std::vector<uint16_t> ids(NUM_ENVS * 6);
+    for (size_t i = 0; i < NUM_ENVS; i++) {
+        seeds[i] = 1000 + static_cast<uint32_t>(i);
+        for (size_t k = 0; k < 6; k++) ids[i * 6 + k] = static_cast<uint16_t>((i * 37 + k * 101) % 800 + 1);
+    }
+    env.reset(seeds.data(), NUM_ENVS);
+    env.setTeamsFromIds(ids.data(), NUM_ENVS, 50);
+}
+
+static std::string readFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+static void test_observation_encoder() {
+    std::cout << "Testing observation encoder..." << std::endl;
+
+    BattleEngine engine;
+    Pokemon team[3];
+    for (int i = 0; i < 3; i++) team[i] = FactoryGenerator::createPokemon(10 + i, 50);
+    engine.reset(5);
+    engine.setPlayerTeam(team, 3);
+    for (int i = 0; i < 3; i++) team[i] = FactoryGenerator::createPokemon(400 + i, 50);
+    engine.setOpponentTeam(team, 3);
+
+    float own[OBS_SIZE], foe[OBS_SIZE];
+    encodeObservation(engine.getState(), 0, own);
+    encodeObservation(engine.getState(), 1, foe);
+    const BattleState& state = engine.getState();
+    ASSERT(own[0] == 1.0f && own[28] == 1.0f && own[29] == 1.0f, "Fresh battle should be at full HP and party");
+    ASSERT(own[2] == state.getActivePokemon(0).species / 412.0f, "Own species should come first");
+    ASSERT(own[2] == foe[3] && own[3] == foe[2], "Sides should mirror");
+    ASSERT(own[18] == state.getActivePokemon(0).moves[0] / 355.0f, "Own moves encoded");
+
+    uint8_t mask[NUM_ACTION_TYPES];
+    encodeActionMask(engine, 0, mask);
+    std::vector<Action> legal = engine.getLegalActions();
+    int set = 0;
+    for (uint8_t m : mask) set += m;
+    ASSERT(set == static_cast<int>(legal.size()), "Mask should mark every legal action");
+    for (const Action& a : legal) ASSERT(mask[static_cast<int>(a.type)] == 1, "Legal action missing from mask");
+
+    std::cout << "  Observation encoder passed" << std::endl;
+}
+
+static void test_record_and_rotate() {
+    std::cout << "Testing trajectory recorder..." << std::endl;
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "test_trajectory_out";
+    std::filesystem::remove_all(dir);
+
+    VecBattleEnv env(NUM_ENVS), reference(NUM_ENVS);
+    setupEnv(env);
+    setupEnv(reference);
+
+    const size_t steps = 20;
+    const size_t rowsPerShard = 50;  // Four steps of 12 rows per shard
+    std::vector<float> expectedObs, expectedRewards;
+    std::vector<uint8_t> expectedActions;
+    {
+        TrajectoryRecorder recorder(dir.string(), rowsPerShard, true);
+        std::vector<float> obs(NUM_ENVS * OBS_SIZE);
+        std::vector<uint8_t> masks(NUM_ENVS * NUM_ACTION_TYPES);
+        std::vector<Action> actions(NUM_ENVS);
+        float rewards[NUM_ENVS], refRewards[NUM_ENVS];
+        bool dones[NUM_ENVS], refDones[NUM_ENVS];
+
+        for (size_t t = 0; t < steps; t++) {
+            reference.observe(obs.data(), masks.data(), nullptr, NUM_ENVS);
+            for (size_t i = 0; i < NUM_ENVS; i++) {
+                actions[i] = reference.getLegalActions(i).front();
+                expectedActions.push_back(static_cast<uint8_t>(actions[i].type));
+            }
+            expectedObs.insert(expectedObs.end(), obs.begin(), obs.end());
+
+            recorder.recordStep(env, actions.data(), rewards, dones, NUM_ENVS);
+            reference.step(actions.data(), refRewards, refDones, NUM_ENVS);
+            for (size_t i = 0; i < NUM_ENVS; i++) {
+                ASSERT(rewards[i] == refRewards[i] && dones[i] == refDones[i],
+                       "Recording (and AI scoring) should not change the battle");
+                ASSERT(env.getState(i).hash == reference.getState(i).hash, "States should stay identical");
+            }
+            expectedRewards.insert(expectedRewards.end(), rewards, rewards + NUM_ENVS);
+        }
+        ASSERT(recorder.rows() == steps * NUM_ENVS, "Row count");
+        ASSERT(recorder.shardRowsLeft() == rowsPerShard - 48, "A 12-row step doesn't fit the last 2 rows");
+        recorder.close();
+        ASSERT(recorder.shardRowsLeft() == 0, "Nothing fits after close");
+
+        bool threw = false;
+        try {
+            recorder.reserve(1);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        ASSERT(threw, "Reserving after close should throw");
+    }
+
+    // 240 rows at 48 per shard
+    const size_t rowsPerFullShard = (rowsPerShard / NUM_ENVS) * NUM_ENVS;
+    const size_t shards = (steps * NUM_ENVS + rowsPerFullShard - 1) / rowsPerFullShard;
+    std::string manifest = readFile(dir / "manifest.json");
+    ASSERT(manifest.find("\"ai_scores\"") != std::string::npos, "Manifest should list AI scores");
+    ASSERT(manifest.find("\"shards\": [48, 48, 48, 48, 48]") != std::string::npos, "Manifest should list shards");
+    ASSERT(!std::filesystem::exists(dir / "obs.000005.bin"), "Unused prepared shard should be removed");
+
+    std::string obs, actions, rewards, scores;
+    for (size_t s = 0; s < shards; s++) {
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), ".%06zu.bin", s);
+        obs += readFile(dir / ("obs" + std::string(suffix)));
+        actions += readFile(dir / ("action" + std::string(suffix)));
+        rewards += readFile(dir / ("reward" + std::string(suffix)));
+        scores += readFile(dir / ("ai_scores" + std::string(suffix)));
+    }
+    ASSERT(obs.size() == expectedObs.size() * sizeof(float), "Obs files should be trimmed to their rows");
+    ASSERT(std::memcmp(obs.data(), expectedObs.data(), obs.size()) == 0, "Obs should match observe()");
+    ASSERT(actions.size() == expectedActions.size() &&
+           std::memcmp(actions.data(), expectedActions.data(), actions.size()) == 0, "Actions should match");
+    ASSERT(std::memcmp(rewards.data(), expectedRewards.data(), rewards.size()) == 0, "Rewards should match");
+    bool anyScore = false;
+    for (char c : scores) anyScore |= c != 0;
+    ASSERT(scores.size() == steps * NUM_ENVS * 4 && anyScore, "AI scores should be recorded");
+
+    std::filesystem::remove_all(dir);
+    std::cout << "  Trajectory recorder passed" << std::endl;
+}
+
+static void test_flusher_error() {
+    std::cout << "Testing trajectory flusher errors..." << std::endl;
+
+    // A directory where shard 1's obs file goes makes preparing it fail
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "test_trajectory_error";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "obs.000001.bin");
+
+    VecBattleEnv env(NUM_ENVS);
+    setupEnv(env);
+    std::vector<Action> actions(NUM_ENVS);
+    for (size_t i = 0; i < NUM_ENVS; i++) actions[i] = env.getLegalActions(i).front();
+    {
+        TrajectoryRecorder recorder(dir.string(), NUM_ENVS, false);
+        recorder.recordStep(env, actions.data(), nullptr, nullptr, NUM_ENVS);  // Fills shard 0
+
+        // The error surfaces on rotation, and again on every retry instead of crashing
+        for (int attempt = 0; attempt < 3; attempt++) {
+            bool threw = false;
+            try {
+                recorder.recordStep(env, actions.data(), nullptr, nullptr, NUM_ENVS);
+            } catch (const std::runtime_error&) {
+                threw = true;
+            }
+            ASSERT(threw, "Rotating onto a shard that failed to open should throw");
+        }
+        bool threw = false;
+        try {
+            recorder.close();
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        ASSERT(threw, "Close should report the flusher error");
+    }
+
+    std::filesystem::remove_all(dir);
+    std::cout << "  Trajectory flusher errors passed" << std::endl;
+}
+
+static void test_finish_error() {
+    std::cout << "Testing trajectory shard finish errors..." << std::endl;
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "test_trajectory_finish";
+    std::filesystem::remove_all(dir);
+
+    VecBattleEnv env(NUM_ENVS);
+    setupEnv(env);
+    std::vector<Action> actions(NUM_ENVS);
+    for (size_t i = 0; i < NUM_ENVS; i++) actions[i] = env.getLegalActions(i).front();
+    {
+        TrajectoryRecorder recorder(dir.string(), NUM_ENVS, false);
+        recorder.recordStep(env, actions.data(), nullptr, nullptr, NUM_ENVS);  // Fills shard 0
+
+        // Shard 0 loses its obs file, so finishing it fails once it retires
+        std::filesystem::remove(dir / "obs.000000.bin");
+        for (int step = 0; step < 3; step++) {
+            try {
+                recorder.recordStep(env, actions.data(), nullptr, nullptr, NUM_ENVS);
+            } catch (const std::runtime_error&) {
+                // Depending on timing, later rotations already see the error
+            }
+        }
+        bool threw = false;
+        try {
+            recorder.close();
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        ASSERT(threw, "Close should report the failed shard");
+    }
+
+    // Later shards finished fine, but listing them would shift every one onto its predecessor's file
+    std::string manifest = readFile(dir / "manifest.json");
+    ASSERT(manifest.find("\"shards\": []") != std::string::npos,
+           "Manifest should not list shards after a failed one");
+
+    std::filesystem::remove_all(dir);
+    std::cout << "  Trajectory shard finish errors passed" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Trajectory Tests ===" << std::endl;
+
+    test_observation_encoder();
+    test_record_and_rotate();
+    test_flusher_error();
+#ifndef _WIN32
+    test_finish_error();  // Open files can't be removed on Windows
+#endif
+
+    std::cout << "\nAll trajectory tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,243 @@
+// Builds an imitation-learning dataset from the scripted Frontier AI.
+//
+// Usage: build_imitation_dataset --out dir [--games N] [--seed S]
+//                                [--challenges 0,1,2:3,...] [--open-level P]
+//                                [--max-turns T] [--threads N] [--shard-rows R]
+//
+// Plays Battle Factory battles with the scripted AI on both sides, teams
+// drawn by FactoryGenerator, and records one row per side per turn in the
+// TrajectoryRecorder format (trajectory.hpp): the observation from that
+// side's view, its legal-action mask, the four aiThinking scores, the move
+// the AI chose, the reward from that side's view and the done flag. The env
+// column holds game * 2 + side; workers append whole games in batches, so
+// games are contiguous but not in order.
+//
+// --challenges picks each game's challenge from a weighted list ("c" or
+// "c:weight", default 0-7 uniformly); --open-level is the fraction of games
+// played at Open Level (Lv100) instead of Lv50.
+
+#include "trajectory.hpp"
+#include "ai.hpp"
+#include "data.hpp"
+#include "factory.hpp"
+#include "observation.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace pkmn;
+
+static void usage() {
+    std::cerr << "Usage: build_imitation_dataset --out dir [--games N] [--seed S] [--challenges 0,1,2:3,...]\n"
+                 "                               [--open-level P] [--max-turns T] [--threads N] [--shard-rows R]\n";
+}
+
+struct ChallengeWeight {
+    int challenge;
+    uint32_t weight;
+};
+
+static bool parseChallenges(const char* text, std::vector<ChallengeWeight>& out) {
+    out.clear();
+    const char* p = text;
+    while (*p) {
+        char* end;
+        long challenge = std::strtol(p, &end, 10);
+        if (end == p || challenge < 0 || challenge > 7) return false;
+        long weight = 1;
+        p = end;
+        if (*p == ':') {
+            weight = std::strtol(p + 1, &end, 10);
+            if (end == p + 1 || weight <= 0) return false;
+            p = end;
+        }
+        out.push_back({static_cast<int>(challenge), static_cast<uint32_t>(weight)});
+        if (*p == ',') p++;
+        else if (*p) return false;
+    }
+    return !out.empty();
+}
+
+// Rows recorded by one worker chunk, handed to the recorder in batches
+struct RowBuffer {
+    std::vector<float> obs;
+    std::vector<uint8_t> masks, actions;
+    std::vector<float> rewards;
+    std::vector<uint8_t> dones;
+    std::vector<int8_t> scores;
+    std::vector<uint32_t> envs;
+
+    size_t size() const { return actions.size(); }
+
+    void clear() {
+        obs.clear();
+        masks.clear();
+        actions.clear();
+        rewards.clear();
+        dones.clear();
+        scores.clear();
+        envs.clear();
+    }
+
+    /// Append to the recorder; the first IO error is kept in `error` and
+    /// later flushes are dropped, so the other workers finish their games
+    void flush(TrajectoryRecorder& recorder, std::mutex& mutex, std::exception_ptr& error) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) {
+            try {
+                append(recorder);
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        clear();
+    }
+
+    /// Fill the current shard before starting the next, so every shard but
+    /// the last holds exactly rowsPerShard rows
+    void append(TrajectoryRecorder& recorder) const {
+        for (size_t begin = 0; begin < size();) {
+            const size_t left = recorder.shardRowsLeft();
+            const size_t n = std::min(size() - begin, left > 0 ? left : recorder.rowsPerShard());
+            TrajectoryRows rows = recorder.reserve(n);
+            std::memcpy(rows.obs, obs.data() + begin * OBS_SIZE, n * OBS_SIZE * sizeof(float));
+            std::memcpy(rows.masks, masks.data() + begin * NUM_ACTION_TYPES, n * NUM_ACTION_TYPES);
+            std::memcpy(rows.actions, actions.data() + begin, n);
+            std::memcpy(rows.rewards, rewards.data() + begin, n * sizeof(float));
+            for (size_t i = 0; i < n; i++) rows.dones[i] = dones[begin + i] != 0;
+            std::memcpy(rows.aiScores, scores.data() + begin * 4, n * 4);
+            std::memcpy(rows.envs, envs.data() + begin, n * sizeof(uint32_t));
+            begin += n;
+        }
+    }
+};
+
+static constexpr size_t FLUSH_ROWS = 4096;
+static constexpr size_t GAME_GRAIN = 32;
+
+int main(int argc, char** argv) {
+    std::string out;
+    uint32_t games = 10000;
+    uint64_t seed = 1;
+    std::vector<ChallengeWeight> challenges;
+    for (int c = 0; c < 8; c++) challenges.push_back({c, 1});
+    double openLevel = 0.5;
+    uint16_t maxTurns = 200;
+    size_t threads = 0;
+    size_t shardRows = TRAJECTORY_DEFAULT_SHARD_ROWS;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (!std::strcmp(arg, "--out")) out = value;
+        else if (!std::strcmp(arg, "--games")) games = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(arg, "--seed")) seed = std::strtoull(value, nullptr, 10);
+        else if (!std::strcmp(arg, "--challenges") && parseChallenges(value, challenges)) continue;
+        else if (!std::strcmp(arg, "--open-level")) openLevel = std::clamp(std::atof(value), 0.0, 1.0);
+        else if (!std::strcmp(arg, "--max-turns")) maxTurns = static_cast<uint16_t>(std::strtoul(value, nullptr, 10));
+        else if (!std::strcmp(arg, "--threads")) threads = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(arg, "--shard-rows")) shardRows = std::strtoull(value, nullptr, 10);
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (out.empty() || shardRows == 0) {
+        usage();
+        return 1;
+    }
+
+    uint32_t totalWeight = 0;
+    for (const ChallengeWeight& c : challenges) totalWeight += c.weight;
+    const uint64_t openThreshold = static_cast<uint64_t>(openLevel * 4294967296.0);
+
+    std::cout << "Building imitation dataset: " << games << " games, " << ThreadPool::resolveThreadCount(threads)
+              << " threads\n";
+    auto start = std::chrono::steady_clock::now();
+    try {
+        TrajectoryRecorder recorder(out, shardRows, true);
+        std::mutex recorderMutex;
+        std::exception_ptr error;
+
+        parallelFor(games, threads, GAME_GRAIN, [&](size_t begin, size_t end, size_t) {
+            RowBuffer buffer;
+            BattleEngine engine;
+            for (size_t g = begin; g < end; g++) {
+                // Challenge and level mode
+                uint32_t pick = deriveSeed(seed, 0, g) % totalWeight;
+                int challenge = challenges.back().challenge;
+                for (const ChallengeWeight& c : challenges) {
+                    if (pick < c.weight) {
+                        challenge = c.challenge;
+                        break;
+                    }
+                    pick -= c.weight;
+                }
+                const bool open = deriveSeed(seed, 1, g) < openThreshold;
+
+                // Teams: the player's first three rentals against a regular trainer
+                uint32_t teamSeed = deriveSeed(seed, 2, g);
+                FactoryGenerator::RentalPool pool;
+                FactoryGenerator::OpponentTeam opponent;
+                FactoryGenerator::generateRentalPool(teamSeed, challenge, open, pool);
+                SpeciesSet excluded;
+                for (int k = 0; k < 3; k++) excluded.set(getFrontierMon(pool[k]).species);
+                FactoryGenerator::generateOpponentTeam(teamSeed, challenge, static_cast<int>(g % 7), open, excluded,
+                                                       opponent);
+
+                Pokemon teams[2][3];
+                for (int k = 0; k < 3; k++) {
+                    teams[0][k] = FactoryGenerator::createPokemon(pool[k], open ? 100 : 50);
+                    teams[1][k] = FactoryGenerator::createPokemon(opponent[k], open ? 100 : 50);
+                }
+                engine.reset(deriveSeed(seed, 3, g));
+                engine.setPlayerTeam(teams[0], 3);
+                engine.setOpponentTeam(teams[1], 3);
+
+                while (!engine.isTerminal() && engine.getTurnCount() < maxTurns) {
+                    Action chosen[2];
+                    const size_t row = buffer.size();
+                    for (uint8_t side = 0; side < 2; side++) {
+                        buffer.obs.resize(buffer.obs.size() + OBS_SIZE);
+                        buffer.masks.resize(buffer.masks.size() + NUM_ACTION_TYPES);
+                        buffer.scores.resize(buffer.scores.size() + 4);
+                        encodeObservation(engine.getState(), side, buffer.obs.data() + (row + side) * OBS_SIZE);
+                        encodeActionMask(engine, side, buffer.masks.data() + (row + side) * NUM_ACTION_TYPES);
+                        chosen[side] = chooseAIAction(engine, side, buffer.scores.data() + (row + side) * 4);
+                        buffer.actions.push_back(static_cast<uint8_t>(chosen[side].type));
+                        buffer.envs.push_back(static_cast<uint32_t>(g * 2 + side));
+                    }
+                    StepResult result = engine.stepBoth(chosen[0], chosen[1]);
+                    buffer.rewards.push_back(result.reward);
+                    buffer.rewards.push_back(-result.reward);
+                    buffer.dones.push_back(result.done);
+                    buffer.dones.push_back(result.done);
+                }
+                if (buffer.size() >= FLUSH_ROWS) buffer.flush(recorder, recorderMutex, error);
+            }
+            buffer.flush(recorder, recorderMutex, error);
+        });
+        if (error) std::rethrow_exception(error);
+
+        recorder.close();
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Wrote " << recorder.rows() << " rows to " << out << " in " << secs << "s ("
+                  << games / secs << " games/s, " << recorder.rows() / secs << " rows/s)\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
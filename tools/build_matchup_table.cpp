@@ -0,0 +1,67 @@
+// Builds the frontier 1v1 matchup table used by MatchupTable.
+//
+// Usage: build_matchup_table [--out matchups.bin] [--samples K] [--threads N]
+//                            [--seed S] [--mons M] [--max-turns T]
+//
+// The full table (882 mons, both level modes) is 2 * 882 * 882 * K battles;
+// --mons limits it to the first M frontier mons for quick runs.
+
+#include "matchup_table.hpp"
+#include "data.hpp"
+#include "thread_pool.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace pkmn;
+
+static void usage() {
+    std::cerr << "Usage: build_matchup_table [--out path] [--samples K] [--threads N] "
+                 "[--seed S] [--mons M] [--max-turns T]\n";
+}
+
+int main(int argc, char** argv) {
+    std::string out = "matchups.bin";
+    uint32_t samples = 16;
+    size_t threads = 0;
+    uint32_t seed = 1;
+    uint16_t mons = NUM_FRONTIER_MONS;
+    uint16_t maxTurns = 200;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (!std::strcmp(arg, "--out")) out = value;
+        else if (!std::strcmp(arg, "--samples")) samples = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(arg, "--threads")) threads = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(arg, "--seed")) seed = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(arg, "--mons")) mons = static_cast<uint16_t>(std::strtoul(value, nullptr, 10));
+        else if (!std::strcmp(arg, "--max-turns")) maxTurns = static_cast<uint16_t>(std::strtoul(value, nullptr, 10));
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::cout << "Building matchup table: " << mons << " mons x 2 levels, " << samples
+              << " samples per pair, " << ThreadPool::resolveThreadCount(threads) << " threads\n";
+
+    auto start = std::chrono::steady_clock::now();
+    try {
+        MatchupTable::build(out, samples, seed, threads, mons, maxTurns);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double battles = 2.0 * mons * mons * samples;
+    std::cout << "Wrote " << out << " in " << secs << "s (" << battles / secs << " battles/s)\n";
+    return 0;
+}
@@ -0,0 +1,170 @@
+// Records and verifies battle replays (replay.hpp).
+//
+// Usage: replay_tool record --out games.rpl [--games N] [--seed S] [--level L]
+//                           [--opponent scripted|random|maxdamage] [--max-turns T]
+//                           [--threads N]
+//        replay_tool verify games.rpl [--threads N]
+//
+// record plays random-player battles between teams drawn from Factory rental
+// pools. verify re-simulates every replay in parallel and exits with status 1
+// if any state hash or winner differs, e.g. after an engine change.
+
+#include "replay.hpp"
+#include "factory.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace pkmn;
+
+static void usage() {
+    std::cerr << "Usage: replay_tool record --out path [--games N] [--seed S] [--level L]\n"
+                 "                          [--opponent scripted|random|maxdamage] [--max-turns T] [--threads N]\n"
+                 "       replay_tool verify path [--threads N]\n";
+}
+
+static bool parsePolicy(const char* name, PolicyKind& out) {
+    if (!std::strcmp(name, "scripted")) out = PolicyKind::ScriptedAI;
+    else if (!std::strcmp(name, "random")) out = PolicyKind::Random;
+    else if (!std::strcmp(name, "maxdamage")) out = PolicyKind::MaxDamage;
+    else return false;
+    return true;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int record(int argc, char** argv) {
+    std::string out;
+    uint32_t games = 1000;
+    uint64_t seed = 1;
+    int level = 50;
+    PolicyKind opponent = PolicyKind::ScriptedAI;
+    uint16_t maxTurns = 200;
+    size_t threads = 0;
+
+    for (int i = 2; i < argc; i++) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (!std::strcmp(arg, "--out")) out = value;
+        else if (!std::strcmp(arg, "--games")) games = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(arg, "--seed")) seed = std::strtoull(value, nullptr, 10);
+        else if (!std::strcmp(arg, "--level")) level = std::atoi(value);
+        else if (!std::strcmp(arg, "--max-turns")) maxTurns = static_cast<uint16_t>(std::strtoul(value, nullptr, 10));
+        else if (!std::strcmp(arg, "--threads")) threads = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(arg, "--opponent") && parsePolicy(value, opponent)) continue;
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (out.empty()) {
+        usage();
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Replay> replays(games);
+    parallelFor(games, threads, 8, [&](size_t begin, size_t end, size_t) {
+        BattleEngine engine;
+        for (size_t g = begin; g < end; g++) {
+            Replay& replay = replays[g];
+            uint32_t poolSeed = deriveSeed(seed, 0, g);
+            FactoryGenerator::RentalPool pool;
+            FactoryGenerator::generateRentalPool(poolSeed, 0, level > 50, pool);
+            for (int k = 0; k < 6; k++) replay.teamIds[k] = pool[k];
+            replay.seed = deriveSeed(seed, 1, g);
+            replay.level = static_cast<uint8_t>(level);
+            replay.opponentPolicy = Policy(opponent);
+
+            // The player picks from its own stream: drawing on the engine's RNG
+            // (as PolicyKind::Random does) would not be reproduced on replay
+            const uint32_t playerSeed = deriveSeed(seed, 2, g);
+            startReplay(engine, replay);
+            while (!engine.isTerminal() && engine.getTurnCount() < maxTurns) {
+                Action legal[MAX_LEGAL_ACTIONS];
+                int count = engine.getLegalActions(0, legal);
+                recordStep(engine, replay, legal[deriveSeed(playerSeed, 0, replay.actions.size()) % count]);
+            }
+        }
+    });
+
+    size_t turns = 0;
+    try {
+        ReplayWriter writer(out);
+        for (const Replay& replay : replays) {
+            writer.write(replay);
+            turns += replay.actions.size();
+        }
+        writer.close();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << games << " replays (" << turns << " turns) to " << out << " in " << secondsSince(start)
+              << "s\n";
+    return 0;
+}
+
+static int verify(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+    const std::string path = argv[2];
+    size_t threads = 0;
+    for (int i = 3; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::vector<Replay> replays;
+    try {
+        replays = readReplays(path);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ReplayVerification> results = verifyReplays(replays, threads);
+    double secs = secondsSince(start);
+
+    size_t turns = 0, failures = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        turns += results[i].turns;
+        if (results[i].ok()) continue;
+        if (failures++ < 10) {
+            std::cout << "Replay " << i << ": ";
+            if (results[i].divergedTurn >= 0) std::cout << "state diverged on turn " << results[i].divergedTurn;
+            else std::cout << "winner differs";
+            std::cout << "\n";
+        }
+    }
+    std::cout << "Verified " << replays.size() << " replays (" << turns << " turns) in " << secs << "s ("
+              << turns / std::max(secs, 1e-9) << " turns/s, " << ThreadPool::resolveThreadCount(threads)
+              << " threads): " << failures << " mismatched\n";
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && !std::strcmp(argv[1], "record")) return record(argc, argv);
+    if (argc >= 2 && !std::strcmp(argv[1], "verify")) return verify(argc, argv);
+    usage();
+    return 1;
+}